@@ -37,6 +37,9 @@ Copy-Item "$BuildDir\keystroke-history.dll" -Destination "$PackageDir\obs-plugin
 # Copy locale files
 Copy-Item "$ProjectRoot\data\locale\en-US.ini" -Destination "$PackageDir\data\obs-plugins\keystroke-history\locale\"
 
+# Copy text shader
+Copy-Item "$ProjectRoot\data\keystroke-text.effect" -Destination "$PackageDir\data\obs-plugins\keystroke-history\"
+
 # Create README for manual installation
 Write-Host "[3/4] Creating installation instructions..." -ForegroundColor Green
 $InstallReadme = @"
@@ -73,6 +76,7 @@ Right-click install-plugin.ps1 → Run with PowerShell
 After installation, you should see:
 - C:\Program Files\obs-studio\obs-plugins\64bit\keystroke-history.dll
 - C:\Program Files\obs-studio\data\obs-plugins\keystroke-history\locale\en-US.ini
+- C:\Program Files\obs-studio\data\obs-plugins\keystroke-history\keystroke-text.effect
 
 ## Troubleshooting
 
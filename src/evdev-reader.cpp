@@ -0,0 +1,293 @@
+#include "evdev-reader.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <linux/input.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Older headers only have the timeval member
+#ifndef input_event_sec
+#define input_event_sec time.tv_sec
+#define input_event_usec time.tv_usec
+#endif
+
+// Records taken per read()
+#define EVDEV_BATCH 64
+
+#define EVDEV_STOP_TOKEN UINT32_MAX
+
+#define BITS_PER_LONG (sizeof(unsigned long) * CHAR_BIT)
+#define BIT_WORDS(n) (((n) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+
+struct evdev_source {
+    int fd;
+    bool owned;
+    unsigned char partial[sizeof(struct input_event)]; // Record split across reads (pipes)
+    size_t partial_bytes;
+    uint64_t records;
+};
+
+struct evdev_reader {
+    evdev_batch_fn callback;
+    void* data;
+    int epoll_fd;
+    int stop_fd;                        // eventfd, signalled by destroy
+    std::vector<evdev_source> sources;  // Fixed once the thread runs
+    std::thread thread;
+
+    // Diagnostics (the thread and evdev_reader_pump may both count)
+    std::atomic<uint64_t> records;
+    std::atomic<uint64_t> batches;
+};
+
+// One read() worth of records from a source; false on EOF or a dead device
+static bool read_source(evdev_reader* reader, evdev_source* source)
+{
+    const size_t record_size = sizeof(struct input_event);
+    unsigned char buffer[EVDEV_BATCH * sizeof(struct input_event)];
+
+    memcpy(buffer, source->partial, source->partial_bytes);
+    ssize_t n = read(source->fd, buffer + source->partial_bytes, sizeof(buffer) - source->partial_bytes);
+    if (n < 0)
+        return errno == EAGAIN || errno == EINTR;
+    if (n == 0)
+        return false;
+
+    size_t total = source->partial_bytes + (size_t)n;
+    size_t count = total / record_size;
+    source->partial_bytes = total % record_size;
+    memcpy(source->partial, buffer + count * record_size, source->partial_bytes);
+
+    evdev_event events[EVDEV_BATCH];
+    for (size_t i = 0; i < count; i++) {
+        struct input_event raw;
+        memcpy(&raw, buffer + i * record_size, record_size);
+        events[i].type = raw.type;
+        events[i].code = raw.code;
+        events[i].value = raw.value;
+        events[i].timestamp = (uint64_t)raw.input_event_sec * 1000000000ULL +
+                              (uint64_t)raw.input_event_usec * 1000ULL;
+    }
+
+    if (count > 0) {
+        reader->callback(reader->data, events, count);
+        source->records += count;
+        reader->records.fetch_add(count, std::memory_order_relaxed);
+        reader->batches.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+static void remove_source(evdev_reader* reader, evdev_source* source)
+{
+    epoll_ctl(reader->epoll_fd, EPOLL_CTL_DEL, source->fd, nullptr);
+    if (source->owned)
+        close(source->fd);
+    source->fd = -1;
+}
+
+static void reader_thread(evdev_reader* reader)
+{
+    os_set_thread_name("keystroke-history: evdev");
+
+    struct epoll_event ready[16];
+    for (;;) {
+        int n = epoll_wait(reader->epoll_fd, ready, 16, -1);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            blog(LOG_ERROR, "[INPUT] epoll_wait failed: %s", strerror(errno));
+            return;
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (ready[i].data.u32 == EVDEV_STOP_TOKEN)
+                return;
+
+            evdev_source* source = &reader->sources[ready[i].data.u32];
+            if (source->fd >= 0 && !read_source(reader, source)) {
+                blog(LOG_INFO, "[INPUT] Input device fd %d closed", source->fd);
+                remove_source(reader, source);
+            }
+        }
+    }
+}
+
+evdev_reader* evdev_reader_create(evdev_batch_fn callback, void* data)
+{
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    int stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || stop_fd < 0) {
+        blog(LOG_ERROR, "[INPUT] Failed to create epoll/eventfd: %s", strerror(errno));
+        if (epoll_fd >= 0)
+            close(epoll_fd);
+        if (stop_fd >= 0)
+            close(stop_fd);
+        return nullptr;
+    }
+
+    struct epoll_event stop = {};
+    stop.events = EPOLLIN;
+    stop.data.u32 = EVDEV_STOP_TOKEN;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &stop);
+
+    evdev_reader* reader = new evdev_reader();
+    reader->callback = callback;
+    reader->data = data;
+    reader->epoll_fd = epoll_fd;
+    reader->stop_fd = stop_fd;
+    reader->records = 0;
+    reader->batches = 0;
+    return reader;
+}
+
+void evdev_reader_destroy(evdev_reader* reader)
+{
+    if (!reader)
+        return;
+
+    if (reader->thread.joinable()) {
+        uint64_t one = 1;
+        if (write(reader->stop_fd, &one, sizeof(one)) < 0) {
+            blog(LOG_WARNING, "[INPUT] Failed to signal the evdev thread: %s", strerror(errno));
+        }
+        reader->thread.join();
+    }
+
+    for (evdev_source& source : reader->sources) {
+        if (source.fd >= 0 && source.owned)
+            close(source.fd);
+    }
+    close(reader->stop_fd);
+    close(reader->epoll_fd);
+
+    if (reader->batches > 0) {
+        blog(LOG_INFO, "[INPUT] evdev: %llu records in %llu batches",
+             (unsigned long long)reader->records.load(), (unsigned long long)reader->batches.load());
+    }
+    delete reader;
+}
+
+bool evdev_reader_add_fd(evdev_reader* reader, int fd, bool owned)
+{
+    if (reader->thread.joinable())
+        return false;
+
+    // Level-triggered with one read per wakeup, so a blocking read must never happen
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return false;
+
+    struct epoll_event watch = {};
+    watch.events = EPOLLIN;
+    watch.data.u32 = (uint32_t)reader->sources.size();
+    if (epoll_ctl(reader->epoll_fd, EPOLL_CTL_ADD, fd, &watch) < 0) {
+        blog(LOG_WARNING, "[INPUT] Can't watch fd %d: %s", fd, strerror(errno));
+        return false;
+    }
+
+    evdev_source source = {};
+    source.fd = fd;
+    source.owned = owned;
+    reader->sources.push_back(source);
+    return true;
+}
+
+static bool test_bit(const unsigned long* bits, unsigned int bit)
+{
+    return (bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1;
+}
+
+// Keyboards, mice and wheels - not power buttons, lid switches or joysticks
+static bool is_input_device(int fd)
+{
+    unsigned long keys[BIT_WORDS(KEY_MAX + 1)] = {};
+    unsigned long rel[BIT_WORDS(REL_MAX + 1)] = {};
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keys)), keys);
+    ioctl(fd, EVIOCGBIT(EV_REL, sizeof(rel)), rel);
+
+    bool keyboard = test_bit(keys, KEY_A) && test_bit(keys, KEY_SPACE);
+    bool mouse = test_bit(keys, BTN_LEFT) || test_bit(rel, REL_WHEEL);
+    return keyboard || mouse;
+}
+
+size_t evdev_reader_open_devices(evdev_reader* reader)
+{
+    DIR* dir = opendir("/dev/input");
+    if (!dir) {
+        blog(LOG_ERROR, "[INPUT] Can't open /dev/input: %s", strerror(errno));
+        return 0;
+    }
+
+    size_t added = 0;
+    size_t denied = 0;
+    while (struct dirent* entry = readdir(dir)) {
+        if (strncmp(entry->d_name, "event", 5) != 0)
+            continue;
+
+        std::string path = std::string("/dev/input/") + entry->d_name;
+        int fd = open(path.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EACCES)
+                denied++;
+            continue;
+        }
+
+        if (!is_input_device(fd)) {
+            close(fd);
+            continue;
+        }
+
+        // Same clock as std::chrono::steady_clock, so hook timestamps line up
+        int clock = CLOCK_MONOTONIC;
+        ioctl(fd, EVIOCSCLOCKID, &clock);
+
+        char name[128] = "";
+        ioctl(fd, EVIOCGNAME(sizeof(name)), name);
+
+        if (evdev_reader_add_fd(reader, fd, true)) {
+            blog(LOG_INFO, "[INPUT] Reading %s (%s)", path.c_str(), name);
+            added++;
+        } else {
+            close(fd);
+        }
+    }
+    closedir(dir);
+
+    if (added == 0 && denied > 0) {
+        blog(LOG_WARNING, "[INPUT] No permission to read /dev/input/event* "
+             "(add the user to the 'input' group)");
+    }
+    return added;
+}
+
+bool evdev_reader_start(evdev_reader* reader)
+{
+    if (reader->thread.joinable())
+        return true;
+
+    reader->thread = std::thread(reader_thread, reader);
+    return true;
+}
+
+uint64_t evdev_reader_pump(evdev_reader* reader, int fd)
+{
+    evdev_source source = {};
+    source.fd = fd;
+
+    while (read_source(reader, &source)) {
+    }
+    return source.records;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decoded evdev record (struct input_event without the kernel header, whose
+// name clashes with ours)
+struct evdev_event {
+    uint16_t type;       // EV_KEY, EV_REL, ...
+    uint16_t code;       // KEY_*, BTN_*, REL_*
+    int32_t value;       // 0 = release, 1 = press, 2 = autorepeat for EV_KEY
+    uint64_t timestamp;  // Record time in ns (CLOCK_MONOTONIC for devices opened here)
+};
+
+// Called with every batch read from one descriptor, on the reader thread
+typedef void (*evdev_batch_fn)(void* data, const evdev_event* events, size_t count);
+
+// Reads struct input_event records in batches from any set of descriptors:
+// /dev/input/event* devices, pipes, or recorded dumps. One thread epolls all
+// of them and hands each batch to the callback. Linux only.
+struct evdev_reader;
+
+evdev_reader* evdev_reader_create(evdev_batch_fn callback, void* data);
+
+// Stops the thread and closes every descriptor the reader owns
+void evdev_reader_destroy(evdev_reader* reader);
+
+// Watch a descriptor; owned descriptors are closed on removal or destroy.
+// Call before evdev_reader_start.
+bool evdev_reader_add_fd(evdev_reader* reader, int fd, bool owned);
+
+// Open every /dev/input/event* device that reports keys, buttons or a wheel
+// and switch it to monotonic timestamps. Returns how many were added.
+size_t evdev_reader_open_devices(evdev_reader* reader);
+
+bool evdev_reader_start(evdev_reader* reader);
+
+// Feed a blocking descriptor to EOF on the calling thread through the same
+// decoding and callback path (regular files can't be epolled). Returns
+// records read.
+uint64_t evdev_reader_pump(evdev_reader* reader, int fd);
@@ -0,0 +1,101 @@
+#include "filter-cache.h"
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+void filter_cache_init(filter_cache* cache)
+{
+    cache->generation.store(0, std::memory_order_relaxed);
+    cache->valid = false;
+    cache->cached_generation = 0;
+    cache->serial = 0;
+    cache->window_id = 0;
+    cache->title[0] = '\0';
+    cache->decision = false;
+    cache->hits = 0;
+    cache->misses = 0;
+}
+
+void filter_cache_invalidate(filter_cache* cache)
+{
+    cache->generation.fetch_add(1, std::memory_order_release);
+}
+
+bool filter_cache_lookup(filter_cache* cache, const window_info_provider* provider,
+    filter_decide_fn decide, void* decide_data)
+{
+    uint32_t generation = cache->generation.load(std::memory_order_acquire);
+
+    // Nothing the decision depends on has changed since it was made
+    uint32_t serial = provider->serial ? provider->serial(provider->data) : 0;
+    if (provider->serial && cache->valid &&
+        cache->cached_generation == generation &&
+        cache->serial == serial) {
+        cache->hits++;
+        return cache->decision;
+    }
+
+    foreground_window_info info;
+    info.id = 0;
+    info.title[0] = '\0';
+
+    bool has_window = provider->get_foreground(provider->data, &info);
+    if (!has_window) {
+        // No foreground window never matches; don't disturb the cached entry
+        return false;
+    }
+
+    if (cache->valid &&
+        cache->cached_generation == generation &&
+        cache->window_id == info.id &&
+        strcmp(cache->title, info.title) == 0) {
+        cache->serial = serial;
+        cache->hits++;
+        return cache->decision;
+    }
+
+    cache->misses++;
+    cache->decision = decide(decide_data, &info);
+    cache->window_id = info.id;
+    memcpy(cache->title, info.title, sizeof(cache->title));
+    cache->cached_generation = generation;
+    cache->serial = serial;
+    cache->valid = true;
+
+    return cache->decision;
+}
+
+#ifdef _WIN32
+static bool win32_get_foreground(void* data, foreground_window_info* info)
+{
+    (void)data;
+
+    HWND hwnd = GetForegroundWindow();
+    if (!hwnd)
+        return false;
+
+    info->id = (uintptr_t)hwnd;
+    info->title[0] = '\0';
+    GetWindowTextA(hwnd, info->title, sizeof(info->title));
+    return true;
+}
+
+window_info_provider default_window_info_provider()
+{
+    return { win32_get_foreground, nullptr, nullptr };
+}
+#else
+static bool null_get_foreground(void* data, foreground_window_info* info)
+{
+    (void)data;
+    (void)info;
+    return false;
+}
+
+window_info_provider default_window_info_provider()
+{
+    return { null_get_foreground, nullptr, nullptr };
+}
+#endif
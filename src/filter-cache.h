@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#define FILTER_TITLE_MAX 256
+
+// Snapshot of the foreground window as seen by the window filter
+struct foreground_window_info {
+    uintptr_t id;                  // Platform window handle (HWND on Windows, XID on X11)
+    char title[FILTER_TITLE_MAX];  // UTF-8/ANSI title, always NUL-terminated
+};
+
+// Where foreground window info comes from. The default provider queries the OS;
+// tests and benchmarks can plug in their own.
+struct window_info_provider {
+    // Returns false if there is no foreground window
+    bool (*get_foreground)(void* data, foreground_window_info* info);
+    // Optional: a counter bumped after every foreground or title change. While
+    // it is unchanged the cached decision is reused without get_foreground.
+    uint32_t (*serial)(void* data);
+    void* data;
+};
+
+// Full (uncached) filter evaluation for a given foreground window
+typedef bool (*filter_decide_fn)(void* data, const foreground_window_info* info);
+
+// Memoizes the last filter decision per (window, title, settings generation).
+// Lookups happen on the hook thread only; the generation may be bumped from any thread.
+struct filter_cache {
+    std::atomic<uint32_t> generation;
+
+    // Hook thread state
+    bool valid;
+    uint32_t cached_generation;
+    uint32_t serial;               // Provider serial the decision was made at
+    uintptr_t window_id;
+    char title[FILTER_TITLE_MAX];
+    bool decision;
+
+    // Diagnostics
+    uint64_t hits;
+    uint64_t misses;
+};
+
+void filter_cache_init(filter_cache* cache);
+
+// Invalidate all cached decisions (call whenever the filter settings change)
+void filter_cache_invalidate(filter_cache* cache);
+
+// Returns the filter decision for the current foreground window, only calling
+// decide() when the window, its title or the settings generation changed.
+// With a provider serial, a hit is a compare and a cached bool.
+bool filter_cache_lookup(filter_cache* cache, const window_info_provider* provider,
+    filter_decide_fn decide, void* decide_data);
+
+// For decide(): true when info is a different window than the cached decision's
+static inline bool filter_cache_window_changed(const filter_cache* cache, const foreground_window_info* info)
+{
+    return !cache->valid || cache->window_id != info->id;
+}
+
+// Provider backed by the platform's window system (no window on unsupported platforms)
+window_info_provider default_window_info_provider();
@@ -0,0 +1,72 @@
+#include "font-cache.h"
+#include <obs-module.h>
+#include <map>
+#include <tuple>
+
+typedef std::tuple<std::string, int, int> font_key;
+
+static std::mutex cache_mutex;
+static std::map<font_key, std::weak_ptr<font_face>> cache_faces;
+
+font_face::~font_face()
+{
+    glyph_rasterizer_destroy(rasterizer);
+    glyph_rasterizer_destroy(measurer);
+}
+
+std::shared_ptr<font_face> font_cache_acquire(const std::string& name, int size, int weight)
+{
+    font_key key(name, size, weight);
+
+    std::lock_guard<std::mutex> lock(cache_mutex);
+
+    auto it = cache_faces.find(key);
+    if (it != cache_faces.end()) {
+        if (auto face = it->second.lock())
+            return face;
+        cache_faces.erase(it);
+    }
+
+    glyph_rasterizer* rasterizer = glyph_rasterizer_create(name, size, weight);
+    if (!rasterizer)
+        return nullptr;
+
+    glyph_rasterizer* measurer = glyph_rasterizer_create(name, size, weight);
+    if (!measurer) {
+        glyph_rasterizer_destroy(rasterizer);
+        return nullptr;
+    }
+
+    auto face = std::make_shared<font_face>();
+    face->name = name;
+    face->size = size;
+    face->weight = weight;
+    face->rasterizer = rasterizer;
+    face->measurer = measurer;
+    glyph_rasterizer_get_metrics(rasterizer, &face->metrics);
+
+    cache_faces[key] = face;
+    blog(LOG_INFO, "[RENDER] Loaded font '%s' %dpx weight %d (%d faces cached)",
+         name.c_str(), size, weight, (int)cache_faces.size());
+    return face;
+}
+
+float font_face_advance(font_face* face, uint32_t codepoint)
+{
+    std::lock_guard<std::mutex> lock(face->advance_mutex);
+
+    auto it = face->advances.find(codepoint);
+    if (it != face->advances.end())
+        return it->second;
+
+    float advance = 0.0f;
+    glyph_rasterizer_measure(face->measurer, codepoint, &advance);
+    face->advances.emplace(codepoint, advance);
+    return advance;
+}
+
+bool font_face_render(font_face* face, uint32_t codepoint, glyph_bitmap* glyph)
+{
+    std::lock_guard<std::mutex> lock(face->mutex);
+    return glyph_rasterizer_render(face->rasterizer, codepoint, glyph);
+}
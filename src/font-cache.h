@@ -0,0 +1,42 @@
+#pragma once
+
+#include "glyph-rasterizer.h"
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define FONT_WEIGHT_REGULAR 400
+
+// One loaded font (HFONT or FT_Face) shared by every source that uses the
+// same face, size and weight. Rasterizers are not thread-safe, so each one
+// has its own mutex. Layouts measure on the video thread while the render
+// worker rasterizes, so measuring uses a second instance of the font and
+// never waits for a glyph to render. Advances are memoized because layouts
+// ask for them far more often than glyphs are rasterized.
+struct font_face {
+    std::string name;
+    int size;
+    int weight;
+    font_metrics metrics;      // Immutable after creation
+
+    std::mutex mutex;
+    glyph_rasterizer* rasterizer;
+
+    std::mutex advance_mutex;
+    glyph_rasterizer* measurer;
+    std::unordered_map<uint32_t, float> advances;
+
+    ~font_face();
+};
+
+// Shared face for (name, size, weight), loading it on first use. Faces are
+// released when the last user drops its reference. nullptr if the font
+// can't be loaded. Thread-safe.
+std::shared_ptr<font_face> font_cache_acquire(const std::string& name, int size,
+    int weight = FONT_WEIGHT_REGULAR);
+
+// Thread-safe glyph queries on a shared face
+float font_face_advance(font_face* face, uint32_t codepoint);
+bool font_face_render(font_face* face, uint32_t codepoint, glyph_bitmap* glyph);
@@ -0,0 +1,130 @@
+#include "glyph-atlas.h"
+#include <obs-module.h>
+#include <algorithm>
+#include <cstring>
+
+// Empty texels between glyphs so linear filtering never bleeds into a neighbour
+#define GLYPH_PADDING 1
+
+static void reset_packing(glyph_atlas* atlas)
+{
+    atlas->shelf_x = GLYPH_PADDING;
+    atlas->shelf_y = GLYPH_PADDING;
+    atlas->shelf_height = 0;
+    atlas->glyphs.clear();
+    atlas->epoch++;
+}
+
+void glyph_atlas_init(glyph_atlas* atlas)
+{
+    atlas->face.reset();
+    atlas->width = GLYPH_ATLAS_WIDTH;
+    atlas->height = GLYPH_ATLAS_MIN_HEIGHT;
+    atlas->pixels.assign((size_t)atlas->width * atlas->height, 0);
+    atlas->dirty = true;
+    atlas->rasterized = 0;
+    atlas->resets = 0;
+    atlas->epoch = 0;
+    reset_packing(atlas);
+}
+
+void glyph_atlas_free(glyph_atlas* atlas)
+{
+    atlas->face.reset();
+    atlas->glyphs.clear();
+    atlas->pixels.clear();
+}
+
+void glyph_atlas_clear(glyph_atlas* atlas)
+{
+    reset_packing(atlas);
+    std::fill(atlas->pixels.begin(), atlas->pixels.end(), 0);
+    atlas->dirty = true;
+    atlas->resets++;
+}
+
+void glyph_atlas_set_face(glyph_atlas* atlas, const std::shared_ptr<font_face>& face)
+{
+    if (atlas->face == face)
+        return;
+
+    atlas->face = face;
+
+    // Start small again for the new font
+    atlas->height = GLYPH_ATLAS_MIN_HEIGHT;
+    atlas->pixels.assign((size_t)atlas->width * atlas->height, 0);
+    reset_packing(atlas);
+    atlas->dirty = true;
+}
+
+// Find room for a width x height box; grows the texture downwards if needed
+static bool allocate(glyph_atlas* atlas, uint32_t width, uint32_t height, uint32_t* x, uint32_t* y)
+{
+    if (atlas->shelf_x + width + GLYPH_PADDING > atlas->width) {
+        // Start a new shelf
+        atlas->shelf_y += atlas->shelf_height + GLYPH_PADDING;
+        atlas->shelf_x = GLYPH_PADDING;
+        atlas->shelf_height = 0;
+    }
+
+    while (atlas->shelf_y + height + GLYPH_PADDING > atlas->height) {
+        if (atlas->height >= GLYPH_ATLAS_MAX_HEIGHT)
+            return false;
+
+        // Rows are appended, so existing glyphs keep their texel positions
+        atlas->height *= 2;
+        atlas->pixels.resize((size_t)atlas->width * atlas->height, 0);
+        atlas->dirty = true;
+    }
+
+    *x = atlas->shelf_x;
+    *y = atlas->shelf_y;
+    atlas->shelf_x += width + GLYPH_PADDING;
+    if (height > atlas->shelf_height)
+        atlas->shelf_height = height;
+    return true;
+}
+
+uint32_t glyph_atlas_used_rows(const glyph_atlas* atlas)
+{
+    return std::min(atlas->shelf_y + atlas->shelf_height + GLYPH_PADDING, atlas->height);
+}
+
+const atlas_glyph* glyph_atlas_get(glyph_atlas* atlas, uint32_t codepoint)
+{
+    auto it = atlas->glyphs.find(codepoint);
+    if (it != atlas->glyphs.end())
+        return &it->second;
+
+    atlas_glyph entry = {};
+    glyph_bitmap& bitmap = atlas->scratch;
+
+    if (atlas->face && font_face_render(atlas->face.get(), codepoint, &bitmap)) {
+        entry.bearing_x = (int16_t)bitmap.bearing_x;
+        entry.bearing_y = (int16_t)bitmap.bearing_y;
+
+        // Glyphs that could never fit are drawn as blanks
+        bool fits = bitmap.width + 2 * GLYPH_PADDING <= (int)atlas->width &&
+                    bitmap.height + 2 * GLYPH_PADDING <= GLYPH_ATLAS_MAX_HEIGHT;
+
+        if (bitmap.width > 0 && bitmap.height > 0 && fits) {
+            uint32_t x, y;
+            if (!allocate(atlas, (uint32_t)bitmap.width, (uint32_t)bitmap.height, &x, &y))
+                return nullptr;
+
+            for (int row = 0; row < bitmap.height; row++) {
+                memcpy(&atlas->pixels[(size_t)(y + row) * atlas->width + x],
+                    &bitmap.coverage[(size_t)row * bitmap.width], bitmap.width);
+            }
+
+            entry.x = (uint16_t)x;
+            entry.y = (uint16_t)y;
+            entry.width = (uint16_t)bitmap.width;
+            entry.height = (uint16_t)bitmap.height;
+            atlas->dirty = true;
+        }
+        atlas->rasterized++;
+    }
+
+    return &atlas->glyphs.emplace(codepoint, entry).first->second;
+}
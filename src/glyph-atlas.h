@@ -0,0 +1,64 @@
+#pragma once
+
+#include "font-cache.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#define GLYPH_ATLAS_WIDTH 1024
+#define GLYPH_ATLAS_MIN_HEIGHT 256
+#define GLYPH_ATLAS_MAX_HEIGHT 2048
+
+// Placement of one rasterized glyph inside the atlas
+struct atlas_glyph {
+    uint16_t x, y;           // Top-left texel in the atlas
+    uint16_t width, height;  // 0 for blank glyphs
+    int16_t bearing_x;
+    int16_t bearing_y;
+};
+
+// Glyph coverage for one font, packed into shelves of a single 8-bit
+// texture. Glyphs are rasterized the first time they are needed and then
+// reused for as long as the face stays the same. Owned by the text
+// renderer's worker thread, which ships a copy of the pixels with its frames
+// whenever they changed; the video thread only uploads those copies and must
+// never touch the atlas itself.
+struct glyph_atlas {
+    std::shared_ptr<font_face> face;  // From the process-wide font cache
+
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> pixels;  // width * height coverage
+    bool dirty;
+
+    // Shelf packer
+    uint32_t shelf_x;
+    uint32_t shelf_y;
+    uint32_t shelf_height;
+
+    std::unordered_map<uint32_t, atlas_glyph> glyphs;
+    glyph_bitmap scratch;
+    uint32_t epoch;  // Bumped whenever cached glyph positions become invalid
+
+    // Diagnostics
+    uint64_t rasterized;
+    uint64_t resets;
+};
+
+void glyph_atlas_init(glyph_atlas* atlas);
+void glyph_atlas_free(glyph_atlas* atlas);
+
+// Switch faces; drops every cached glyph when the face actually changes
+void glyph_atlas_set_face(glyph_atlas* atlas, const std::shared_ptr<font_face>& face);
+
+// Forget all glyphs but keep the face (used when the atlas is full)
+void glyph_atlas_clear(glyph_atlas* atlas);
+
+// Rows from the top that hold glyphs (plus padding); the rest is empty
+uint32_t glyph_atlas_used_rows(const glyph_atlas* atlas);
+
+// Glyph for a codepoint, rasterizing it on first use. Glyphs the font cannot
+// render are cached as blanks. Returns nullptr only when the atlas has no room
+// left at its maximum size; callers then clear it and lay the text out again.
+const atlas_glyph* glyph_atlas_get(glyph_atlas* atlas, uint32_t codepoint);
@@ -0,0 +1,135 @@
+#include "glyph-rasterizer.h"
+#include <obs-module.h>
+#include <fontconfig/fontconfig.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <cstring>
+
+struct glyph_rasterizer {
+    FT_Library library;
+    FT_Face face;
+};
+
+// Resolve a family name ("Arial") to a font file through fontconfig
+static bool find_font_file(const std::string& font_name, int weight, std::string& path, int& index)
+{
+    FcPattern* pattern = FcNameParse((const FcChar8*)font_name.c_str());
+    if (!pattern)
+        return false;
+
+    FcPatternAddInteger(pattern, FC_WEIGHT, FcWeightFromOpenType(weight));
+
+    FcConfigSubstitute(nullptr, pattern, FcMatchPattern);
+    FcDefaultSubstitute(pattern);
+
+    FcResult result;
+    FcPattern* match = FcFontMatch(nullptr, pattern, &result);
+    FcPatternDestroy(pattern);
+    if (!match)
+        return false;
+
+    FcChar8* file = nullptr;
+    bool found = FcPatternGetString(match, FC_FILE, 0, &file) == FcResultMatch;
+    if (found) {
+        path = (const char*)file;
+        if (FcPatternGetInteger(match, FC_INDEX, 0, &index) != FcResultMatch)
+            index = 0;
+    }
+
+    FcPatternDestroy(match);
+    return found;
+}
+
+glyph_rasterizer* glyph_rasterizer_create(const std::string& font_name, int font_size, int weight)
+{
+    std::string path;
+    int index = 0;
+    if (!find_font_file(font_name, weight, path, index)) {
+        blog(LOG_ERROR, "[RENDER] No font found for '%s'", font_name.c_str());
+        return nullptr;
+    }
+
+    FT_Library library;
+    if (FT_Init_FreeType(&library) != 0) {
+        blog(LOG_ERROR, "[RENDER] Failed to initialize FreeType");
+        return nullptr;
+    }
+
+    FT_Face face;
+    if (FT_New_Face(library, path.c_str(), index, &face) != 0) {
+        blog(LOG_ERROR, "[RENDER] Failed to load font '%s'", path.c_str());
+        FT_Done_FreeType(library);
+        return nullptr;
+    }
+
+    // Cell height (ascender - descender), like a positive CreateFontW height
+    FT_Size_RequestRec request = {};
+    request.type = FT_SIZE_REQUEST_TYPE_CELL;
+    request.height = (FT_Long)font_size << 6;
+    if (FT_Request_Size(face, &request) != 0) {
+        FT_Set_Pixel_Sizes(face, 0, font_size);
+    }
+
+    glyph_rasterizer* rasterizer = new glyph_rasterizer();
+    rasterizer->library = library;
+    rasterizer->face = face;
+    return rasterizer;
+}
+
+void glyph_rasterizer_destroy(glyph_rasterizer* rasterizer)
+{
+    if (!rasterizer)
+        return;
+
+    FT_Done_Face(rasterizer->face);
+    FT_Done_FreeType(rasterizer->library);
+    delete rasterizer;
+}
+
+void glyph_rasterizer_get_metrics(glyph_rasterizer* rasterizer, font_metrics* metrics)
+{
+    const FT_Size_Metrics& size = rasterizer->face->size->metrics;
+    metrics->ascent = (int)((size.ascender + 63) >> 6);
+    metrics->descent = (int)((-size.descender + 63) >> 6);
+}
+
+bool glyph_rasterizer_render(glyph_rasterizer* rasterizer, uint32_t codepoint, glyph_bitmap* glyph)
+{
+    FT_Face face = rasterizer->face;
+    if (FT_Load_Char(face, codepoint, FT_LOAD_RENDER | FT_LOAD_TARGET_NORMAL) != 0)
+        return false;
+
+    const FT_GlyphSlot slot = face->glyph;
+    const FT_Bitmap& bitmap = slot->bitmap;
+
+    glyph->advance = (float)slot->advance.x / 64.0f;
+    glyph->bearing_x = slot->bitmap_left;
+    glyph->bearing_y = slot->bitmap_top;
+
+    if (bitmap.pixel_mode != FT_PIXEL_MODE_GRAY || bitmap.width == 0 || bitmap.rows == 0) {
+        glyph->width = 0;
+        glyph->height = 0;
+        glyph->coverage.clear();
+        return true;
+    }
+
+    glyph->width = (int)bitmap.width;
+    glyph->height = (int)bitmap.rows;
+    glyph->coverage.resize((size_t)glyph->width * glyph->height);
+
+    for (int y = 0; y < glyph->height; y++) {
+        memcpy(&glyph->coverage[(size_t)y * glyph->width],
+            bitmap.buffer + (ptrdiff_t)y * bitmap.pitch, glyph->width);
+    }
+
+    return true;
+}
+
+bool glyph_rasterizer_measure(glyph_rasterizer* rasterizer, uint32_t codepoint, float* advance)
+{
+    if (FT_Load_Char(rasterizer->face, codepoint, FT_LOAD_DEFAULT) != 0)
+        return false;
+
+    *advance = (float)rasterizer->face->glyph->advance.x / 64.0f;
+    return true;
+}
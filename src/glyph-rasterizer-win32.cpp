@@ -0,0 +1,230 @@
+#include "glyph-rasterizer.h"
+#include <obs-module.h>
+#include <cstring>
+#include <vector>
+#include <windows.h>
+#include <wingdi.h>
+
+// Use plain GDI (not GDI+) for text rendering - much more stable.
+// Each glyph is drawn white-on-black into a scratch DIB and the coverage is
+// read back, so font fallback and anti-aliasing match DrawText exactly.
+
+struct glyph_rasterizer {
+    HDC hdc;
+    HFONT font;
+    HFONT old_font;
+    HBITMAP bitmap;
+    HBITMAP old_bitmap;
+    uint32_t* pixels;
+    int cell_width;
+    int cell_height;
+    int pad;
+    TEXTMETRICW metrics;
+    std::vector<uint8_t> coverage;  // Whole cell, before trimming
+};
+
+// Anti-aliased coverage of a white-on-black BGRX pixel: the brightest channel
+static inline uint8_t coverage_of(uint32_t pixel)
+{
+    uint8_t b = pixel & 0xFF;
+    uint8_t g = (pixel >> 8) & 0xFF;
+    uint8_t r = (pixel >> 16) & 0xFF;
+    uint8_t coverage = r > g ? r : g;
+    return coverage > b ? coverage : b;
+}
+
+glyph_rasterizer* glyph_rasterizer_create(const std::string& font_name, int font_size, int weight)
+{
+    HDC hdc = CreateCompatibleDC(NULL);
+    if (!hdc) {
+        blog(LOG_ERROR, "[RENDER] Failed to create DC");
+        return nullptr;
+    }
+
+    // Create font - Use CreateFontW for Unicode support
+    // Convert font name from UTF-8 to wide string
+    int wchars_needed = MultiByteToWideChar(CP_UTF8, 0, font_name.c_str(), -1, NULL, 0);
+    std::wstring font_name_wide(wchars_needed, 0);
+    MultiByteToWideChar(CP_UTF8, 0, font_name.c_str(), -1, &font_name_wide[0], wchars_needed);
+
+    HFONT font = CreateFontW(
+        font_size,                    // Height
+        0,                            // Width (auto)
+        0,                            // Escapement
+        0,                            // Orientation
+        weight,                       // Weight (FW_NORMAL = 400)
+        FALSE,                        // Italic
+        FALSE,                        // Underline
+        FALSE,                        // Strikeout
+        DEFAULT_CHARSET,              // Charset
+        OUT_DEFAULT_PRECIS,           // Output precision
+        CLIP_DEFAULT_PRECIS,          // Clipping precision
+        ANTIALIASED_QUALITY,          // Quality
+        DEFAULT_PITCH | FF_DONTCARE,  // Pitch and family
+        font_name_wide.c_str()        // Font name
+    );
+
+    if (!font) {
+        blog(LOG_ERROR, "[RENDER] Failed to create font");
+        DeleteDC(hdc);
+        return nullptr;
+    }
+
+    glyph_rasterizer* rasterizer = new glyph_rasterizer();
+    rasterizer->hdc = hdc;
+    rasterizer->font = font;
+    rasterizer->old_font = (HFONT)SelectObject(hdc, font);
+    GetTextMetricsW(hdc, &rasterizer->metrics);
+
+    // Scratch cell: room for the widest glyph plus overhang on both sides
+    rasterizer->pad = font_size / 2 + 2;
+    rasterizer->cell_width = rasterizer->metrics.tmMaxCharWidth * 2 + rasterizer->pad * 2;
+    rasterizer->cell_height = rasterizer->metrics.tmHeight + rasterizer->pad * 2;
+
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = rasterizer->cell_width;
+    bmi.bmiHeader.biHeight = -rasterizer->cell_height; // Negative for top-down bitmap
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    rasterizer->bitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS,
+        (void**)&rasterizer->pixels, NULL, 0);
+
+    if (!rasterizer->bitmap || !rasterizer->pixels) {
+        blog(LOG_ERROR, "[RENDER] Failed to create bitmap");
+        SelectObject(hdc, rasterizer->old_font);
+        DeleteObject(font);
+        DeleteDC(hdc);
+        delete rasterizer;
+        return nullptr;
+    }
+
+    rasterizer->old_bitmap = (HBITMAP)SelectObject(hdc, rasterizer->bitmap);
+
+    // White text on a black cell: coverage is simply the pixel intensity
+    SetTextColor(hdc, RGB(255, 255, 255));
+    SetBkMode(hdc, TRANSPARENT);
+
+    rasterizer->coverage.resize((size_t)rasterizer->cell_width * rasterizer->cell_height);
+
+    return rasterizer;
+}
+
+void glyph_rasterizer_destroy(glyph_rasterizer* rasterizer)
+{
+    if (!rasterizer)
+        return;
+
+    // Cleanup GDI resources
+    SelectObject(rasterizer->hdc, rasterizer->old_font);
+    DeleteObject(rasterizer->font);
+    SelectObject(rasterizer->hdc, rasterizer->old_bitmap);
+    DeleteObject(rasterizer->bitmap);
+    DeleteDC(rasterizer->hdc);
+    delete rasterizer;
+}
+
+void glyph_rasterizer_get_metrics(glyph_rasterizer* rasterizer, font_metrics* metrics)
+{
+    metrics->ascent = rasterizer->metrics.tmAscent;
+    metrics->descent = rasterizer->metrics.tmDescent;
+}
+
+// UTF-16 for the codepoint (surrogate pair outside the BMP)
+static int to_utf16(uint32_t codepoint, wchar_t text[2])
+{
+    if (codepoint >= 0x10000) {
+        codepoint -= 0x10000;
+        text[0] = (wchar_t)(0xD800 + (codepoint >> 10));
+        text[1] = (wchar_t)(0xDC00 + (codepoint & 0x3FF));
+        return 2;
+    }
+    text[0] = (wchar_t)codepoint;
+    return 1;
+}
+
+bool glyph_rasterizer_measure(glyph_rasterizer* rasterizer, uint32_t codepoint, float* advance)
+{
+    wchar_t text[2];
+    int length = to_utf16(codepoint, text);
+
+    SIZE extent = {};
+    if (!GetTextExtentPoint32W(rasterizer->hdc, text, length, &extent))
+        return false;
+
+    *advance = (float)extent.cx;
+    return true;
+}
+
+bool glyph_rasterizer_render(glyph_rasterizer* rasterizer, uint32_t codepoint, glyph_bitmap* glyph)
+{
+    wchar_t text[2];
+    int length = to_utf16(codepoint, text);
+
+    SIZE extent = {};
+    GetTextExtentPoint32W(rasterizer->hdc, text, length, &extent);
+
+    const int width = rasterizer->cell_width;
+    const int height = rasterizer->cell_height;
+    const int pad = rasterizer->pad;
+    const size_t count = (size_t)width * height;
+    uint8_t* cell = rasterizer->coverage.data();
+
+    // Clear the cell and draw the glyph at (pad, pad)
+    memset(rasterizer->pixels, 0, count * sizeof(uint32_t));
+
+    RECT rect = { pad, pad, width, height };
+    DrawTextW(rasterizer->hdc, text, length, &rect, DT_LEFT | DT_TOP | DT_SINGLELINE | DT_NOPREFIX | DT_NOCLIP);
+    GdiFlush();
+
+    // Coverage = brightest channel, then the inked bounding box
+    for (size_t i = 0; i < count; i++) {
+        cell[i] = coverage_of(rasterizer->pixels[i]);
+    }
+
+    int min_x = width, min_y = height, max_x = -1, max_y = -1;
+    for (int y = 0; y < height; y++) {
+        const uint8_t* row = cell + (size_t)y * width;
+        int first = 0;
+        while (first < width && row[first] == 0)
+            first++;
+        if (first == width)
+            continue;
+
+        int last = width - 1;
+        while (row[last] == 0)
+            last--;
+
+        if (first < min_x) min_x = first;
+        if (last > max_x) max_x = last;
+        if (y < min_y) min_y = y;
+        max_y = y;
+    }
+
+    glyph->advance = (float)extent.cx;
+
+    if (max_x < 0) {
+        // Blank glyph (space etc.)
+        glyph->width = 0;
+        glyph->height = 0;
+        glyph->bearing_x = 0;
+        glyph->bearing_y = 0;
+        glyph->coverage.clear();
+        return true;
+    }
+
+    glyph->width = max_x - min_x + 1;
+    glyph->height = max_y - min_y + 1;
+    glyph->bearing_x = min_x - pad;
+    glyph->bearing_y = rasterizer->metrics.tmAscent - (min_y - pad);
+    glyph->coverage.resize((size_t)glyph->width * glyph->height);
+
+    for (int y = 0; y < glyph->height; y++) {
+        memcpy(&glyph->coverage[(size_t)y * glyph->width],
+            cell + (size_t)(min_y + y) * width + min_x, glyph->width);
+    }
+
+    return true;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Rasterizes single glyphs to 8-bit coverage for the glyph atlas.
+// Implemented with GDI on Windows (same font lookup and anti-aliasing as
+// DrawText) and FreeType + fontconfig everywhere else. Not thread-safe;
+// shared instances live in the font cache, which serializes access.
+struct glyph_rasterizer;
+
+struct font_metrics {
+    int ascent;   // Pixels above the baseline
+    int descent;  // Pixels below the baseline
+};
+
+struct glyph_bitmap {
+    int width;          // Coverage bitmap size (0 for blank glyphs like space)
+    int height;
+    int bearing_x;      // Left edge relative to the pen position
+    int bearing_y;      // Top edge above the baseline
+    float advance;      // Pen advance in pixels
+    std::vector<uint8_t> coverage; // width * height, row-major, 0 = empty
+};
+
+// font_size follows the old CreateFontW semantics: cell height in pixels.
+// weight is on the usual 100..900 scale (400 = regular, 700 = bold).
+glyph_rasterizer* glyph_rasterizer_create(const std::string& font_name, int font_size, int weight);
+void glyph_rasterizer_destroy(glyph_rasterizer* rasterizer);
+
+void glyph_rasterizer_get_metrics(glyph_rasterizer* rasterizer, font_metrics* metrics);
+bool glyph_rasterizer_render(glyph_rasterizer* rasterizer, uint32_t codepoint, glyph_bitmap* glyph);
+
+// Pen advance only, without rasterizing
+bool glyph_rasterizer_measure(glyph_rasterizer* rasterizer, uint32_t codepoint, float* advance);
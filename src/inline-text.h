@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Fixed-capacity UTF-8 string stored inline, so entries holding one never
+// allocate. Appends that don't fit are cut at a character boundary; callers
+// that must not lose text check fits() first.
+template <size_t N>
+struct inline_text {
+    uint32_t length;
+    char data[N];     // Always NUL-terminated
+
+    void clear()
+    {
+        length = 0;
+        data[0] = '\0';
+    }
+
+    bool empty() const { return length == 0; }
+    size_t size() const { return length; }
+    const char* c_str() const { return data; }
+
+    bool fits(size_t extra) const { return length + extra < N; }
+
+    void append(const char* text, size_t count)
+    {
+        if (!fits(count)) {
+            count = N - 1 - length;
+            // Don't leave half a character behind
+            while (count > 0 && ((unsigned char)text[count] & 0xC0) == 0x80)
+                count--;
+        }
+        memcpy(data + length, text, count);
+        length += (uint32_t)count;
+        data[length] = '\0';
+    }
+
+    void append(const char* text) { append(text, strlen(text)); }
+
+    void assign(const char* text, size_t count)
+    {
+        clear();
+        append(text, count);
+    }
+};
@@ -1,75 +1,319 @@
 #include "input-capture.h"
+#include "key-labels.h"
+#include "key-state.h"
 #include <obs-module.h>
 #include <obs.h>
-#include <map>
-#include <set>
 #include <algorithm>
+#include <atomic>
 #include <cctype>
+#include <chrono>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
 
-#ifdef _WIN32
-#include <Windows.h>
+#if defined(_WIN32) || defined(__linux__)
+// Source-mode check against the foreground window (platform part, defined below)
+bool matches_obs_source_target(keystroke_source* context, const capture_settings* settings,
+    const foreground_window_info* info);
 
-// Global state
-static HHOOK g_keyboard_hook = nullptr;
-static HHOOK g_mouse_hook = nullptr;
-static keystroke_source* g_context = nullptr;
-static std::set<int> g_pressed_keys;
-
-// Virtual key code to string mapping
-std::string get_key_name(int vk_code, bool shift_pressed)
-{
-    static const std::map<int, std::string> special_keys = {
-        {VK_BACK, "Backspace"},
-        {VK_TAB, "Tab"},
-        {VK_RETURN, "Enter"},
-        {VK_SPACE, "Space"},
-        {VK_ESCAPE, "Esc"},
-        {VK_PRIOR, "PgUp"},
-        {VK_NEXT, "PgDn"},
-        {VK_END, "End"},
-        {VK_HOME, "Home"},
-        {VK_LEFT, "←"},
-        {VK_UP, "↑"},
-        {VK_RIGHT, "→"},
-        {VK_DOWN, "↓"},
-        {VK_INSERT, "Ins"},
-        {VK_DELETE, "Del"},
-        {VK_F1, "F1"}, {VK_F2, "F2"}, {VK_F3, "F3"}, {VK_F4, "F4"},
-        {VK_F5, "F5"}, {VK_F6, "F6"}, {VK_F7, "F7"}, {VK_F8, "F8"},
-        {VK_F9, "F9"}, {VK_F10, "F10"}, {VK_F11, "F11"}, {VK_F12, "F12"},
-        {VK_NUMLOCK, "NumLock"},
-        {VK_SCROLL, "ScrollLock"},
-        {VK_CAPITAL, "CapsLock"},
-    };
+// Window Capture: the foreground title and the captured one contain each other
+// (target title is lowercased by the resolver)
+static bool matches_window_title(const std::string& target_title, const char* current_window_title)
+{
+    std::string current_title(current_window_title);
+    std::transform(current_title.begin(), current_title.end(), current_title.begin(), ::tolower);
+    
+    return (current_title.find(target_title) != std::string::npos) || (target_title.find(current_title) != std::string::npos);
+}
+
+// Full filter evaluation - only runs when the foreground window, its title or
+// the filter settings changed (see filter_cache_lookup)
+static bool evaluate_window_filter(void* data, const foreground_window_info* info)
+{
+    keystroke_source* context = static_cast<keystroke_source*>(data);
+    const char* window_title = info->title;
+    auto settings = std::atomic_load(&context->capture);
+    
+    // A new foreground window may belong to a process that reused a cached pid
+    if (filter_cache_window_changed(&context->window_filter, info)) {
+        process_cache_revalidate(&context->process_names);
+    }
+    
+    // Check which filtering mode to use
+    if (settings->use_source_capture) {
+        // OBS Source-based filtering
+        static bool logged_mode_once = false;
+        if (!logged_mode_once) {
+            blog(LOG_INFO, "[FILTER] Using OBS source capture mode: '%s'", 
+                 settings->capture_source_name.c_str());
+            logged_mode_once = true;
+        }
+        
+        if (settings->capture_source_name.empty()) {
+            blog(LOG_WARNING, "[FILTER] Source capture enabled but no source specified");
+            return false;
+        }
+        
+        bool matches = matches_obs_source_target(context, settings.get(), info);
+        
+        // Log window changes (not every keystroke)
+        static std::string last_window_title;
+        static bool last_match_result = false;
+        
+        if (std::string(window_title) != last_window_title || matches != last_match_result) {
+            blog(LOG_INFO, "[FILTER] Window: '%s' | Source: '%s' | Match: %s", 
+                 window_title, settings->capture_source_name.c_str(), matches ? "YES" : "NO");
+            last_window_title = window_title;
+            last_match_result = matches;
+        }
+        
+        return matches;
+        
+    } else {
+        // Traditional window title filtering
+        static bool logged_mode_once = false;
+        if (!logged_mode_once) {
+            blog(LOG_INFO, "[FILTER] Using window title filtering mode");
+            logged_mode_once = true;
+        }
+        
+        // Patterns are compiled in keystroke_source_update
+        const window_matcher* matcher = &settings->target_matcher;
+        
+        // If no target window specified, capture from all windows when enabled
+        if (window_matcher_empty(matcher)) {
+            static bool logged_once = false;
+            if (!logged_once) {
+                blog(LOG_INFO, "[FILTER] Window filtering enabled but no target specified - capturing all windows");
+                logged_once = true;
+            }
+            return true;
+        }
+        
+        // Single case-insensitive pass over the title for all include/exclude patterns
+        std::string title(window_title);
+        bool matches = window_matcher_match(matcher, window_title);
+        
+        // Log window changes (not every keystroke)
+        static std::string last_window_title;
+        static bool last_match_result = false;
+        
+        if (title != last_window_title || matches != last_match_result) {
+            blog(LOG_INFO, "[FILTER] Window: '%s' | Target: '%s' | Match: %s", 
+                 window_title, settings->target_window.c_str(), matches ? "YES" : "NO");
+            last_window_title = title;
+            last_match_result = matches;
+        }
+        
+        return matches;
+    }
+}
+
+bool should_capture_input(keystroke_source* context)
+{
+    // If area-based capture is disabled, always capture
+    if (!std::atomic_load(&context->capture)->capture_area_only) {
+        return true;
+    }
     
-    // Check for special keys
-    auto it = special_keys.find(vk_code);
-    if (it != special_keys.end()) {
-        return it->second;
+    return filter_cache_lookup(&context->window_filter, &context->window_provider,
+        evaluate_window_filter, context);
+}
+
+// Capture service: one set of hooks (one evdev thread on Linux) for the whole
+// process, fanned out to every started source. Sources with identical filter
+// settings form a group whose first member evaluates the filter for all of
+// them, so the per-event cost grows with distinct filters, not sources.
+struct capture_group {
+    std::string filter_key;
+    std::vector<keystroke_source*> members;
+};
+
+// What the capture thread fans out to. Immutable once published: every
+// change builds a new one, so the hooks never take a lock.
+struct capture_subscribers {
+    std::vector<keystroke_source*> sources;
+    std::vector<capture_group> groups;
+};
+
+static std::mutex g_service_mutex;      // Serializes start/stop (hook install and removal)
+static std::mutex g_subscribers_mutex;  // Held while the list changes (never by the capture thread)
+static std::vector<keystroke_source*> g_subscribers;
+static std::shared_ptr<const capture_subscribers> g_published; // std::atomic_load/store
+
+// Focused window/control for the privacy guard (platform part, defined below)
+static void read_focus_info(focus_info* info);
+
+// Everything the filter decision depends on; "" = no filtering
+static std::string filter_key(const keystroke_source* context)
+{
+    auto settings = std::atomic_load(&context->capture);
+    if (!settings->capture_area_only)
+        return std::string();
+    if (settings->use_source_capture)
+        return "source:" + settings->capture_source_name;
+    return "title:" + settings->target_window;
+}
+
+// Caller holds g_subscribers_mutex. Returns once the capture thread has let
+// go of the previous set, so a removed source is no longer touched.
+static void publish_subscribers()
+{
+    auto published = std::make_shared<capture_subscribers>();
+    published->sources = g_subscribers;
+    for (keystroke_source* context : g_subscribers) {
+        std::string key = filter_key(context);
+        auto group = std::find_if(published->groups.begin(), published->groups.end(),
+            [&](const capture_group& g) { return g.filter_key == key; });
+        if (group == published->groups.end()) {
+            published->groups.push_back({ key, {} });
+            group = published->groups.end() - 1;
+        }
+        group->members.push_back(context);
+    }
+    
+    auto previous = std::atomic_exchange(&g_published,
+        std::shared_ptr<const capture_subscribers>(published));
+    
+    // The capture thread holds its own reference only while fanning out one
+    // event, and can't pick up the previous set any more
+    while (previous && previous.use_count() > 1) {
+        std::this_thread::yield();
     }
     
-    // Get character representation
-    BYTE keyboard_state[256] = {0};
-    GetKeyboardState(keyboard_state);
+    blog(LOG_INFO, "[INPUT] %zu source(s) in %zu filter group(s)",
+         published->sources.size(), published->groups.size());
+}
+
+// Capture thread (the privacy guards belong to it)
+static void refresh_privacy_state(keystroke_source* context)
+{
+    focus_info info;
+    read_focus_info(&info);
+    privacy_guard_focus_changed(&context->privacy, &info);
+}
+
+static void refresh_all_privacy_states(const capture_subscribers& subscribers)
+{
+    focus_info info;
+    read_focus_info(&info);
+    for (keystroke_source* context : subscribers.sources) {
+        privacy_guard_focus_changed(&context->privacy, &info);
+    }
+}
+
+// Per-source settings that don't depend on the window
+static bool accepts_event(keystroke_source* context, const input_event& event)
+{
+    auto settings = std::atomic_load(&context->capture);
+    if ((event.flags & INPUT_EVENT_KIND_MASK) != INPUT_EVENT_KEY)
+        return settings->show_mouse_clicks;
     
-    WORD chars[2] = {0};
-    int result = ToAscii(vk_code, MapVirtualKey(vk_code, MAPVK_VK_TO_VSC), 
-                        keyboard_state, chars, 0);
+    // Check if we're in a password field (state kept current by focus events)
+    if (privacy_guard_needs_refresh(&context->privacy)) {
+        refresh_privacy_state(context);
+    }
+    if (privacy_guard_suppressed(&context->privacy))
+        return false;
     
-    if (result > 0) {
-        char c = static_cast<char>(chars[0]);
-        if (c >= 32 && c <= 126) { // Printable ASCII
-            // Convert lowercase to uppercase for display
-            if (c >= 'a' && c <= 'z') {
-                c = c - 'a' + 'A';
+    return !(settings->ignore_modifier_keys_alone && is_modifier_key((int)event.code));
+}
+
+// Capture thread: hand an event to every interested source
+static void dispatch_event(const capture_subscribers& subscribers, const input_event& event)
+{
+    for (const capture_group& group : subscribers.groups) {
+        if (!should_capture_input(group.members.front()))
+            continue;
+        
+        for (keystroke_source* context : group.members) {
+            if (accepts_event(context, event)) {
+                input_queue_push(&context->input_events, event);
             }
-            return std::string(1, c);
         }
     }
+}
+
+// Add a source; true if it is the first one (install the hooks)
+static bool subscribe(keystroke_source* context)
+{
+    std::lock_guard<std::mutex> lock(g_subscribers_mutex);
+    
+    // Not visible to the capture thread yet; it reads the focus before the
+    // source's first event
+    context->privacy.has_focus = false;
+    
+    g_subscribers.push_back(context);
+    publish_subscribers();
+    return g_subscribers.size() == 1;
+}
+
+// Remove a source; true if it was the last one (remove the hooks). Once this
+// returns no hook touches the source again.
+static bool unsubscribe(keystroke_source* context)
+{
+    std::lock_guard<std::mutex> lock(g_subscribers_mutex);
+    auto it = std::find(g_subscribers.begin(), g_subscribers.end(), context);
+    if (it == g_subscribers.end())
+        return false;
     
-    return "";
+    g_subscribers.erase(it);
+    publish_subscribers();
+    return g_subscribers.empty();
 }
 
+static void log_capture_stats(keystroke_source* context)
+{
+    blog(LOG_INFO, "[PRIVACY] %llu focus events, %llu rule evaluations",
+         (unsigned long long)context->privacy.focus_events,
+         (unsigned long long)context->privacy.evaluations);
+    
+    if (context->window_filter.hits + context->window_filter.misses > 0) {
+        blog(LOG_INFO, "[FILTER] Decision cache: %llu hits, %llu misses",
+             (unsigned long long)context->window_filter.hits,
+             (unsigned long long)context->window_filter.misses);
+    }
+    if (context->process_names.hits + context->process_names.misses > 0) {
+        blog(LOG_INFO, "[FILTER] Process name cache: %llu hits, %llu misses, %llu evictions",
+             (unsigned long long)context->process_names.hits,
+             (unsigned long long)context->process_names.misses,
+             (unsigned long long)context->process_names.evictions);
+    }
+}
+
+void input_capture_filter_changed(keystroke_source* context)
+{
+    std::lock_guard<std::mutex> lock(g_subscribers_mutex);
+    if (std::find(g_subscribers.begin(), g_subscribers.end(), context) != g_subscribers.end()) {
+        publish_subscribers();
+    }
+}
+#endif
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <future>
+
+// Global state
+static std::thread g_hook_thread;  // Owns the hooks and pumps their messages
+static DWORD g_hook_thread_id = 0;
+static HHOOK g_keyboard_hook = nullptr;
+static HHOOK g_mouse_hook = nullptr;
+static HWINEVENTHOOK g_foreground_event_hook = nullptr;
+static HWINEVENTHOOK g_focus_event_hook = nullptr;
+static HWINEVENTHOOK g_name_event_hook = nullptr;
+static key_state g_key_state; // Hook thread
+
+// Foreground window as of the last foreground or title event, so the window
+// filter never calls into user32 (std::atomic_load/store)
+static std::shared_ptr<const foreground_window_info> g_foreground;
+static std::atomic<uint32_t> g_foreground_serial{0};
+
+// A held key with no event for this long is checked against the OS; autorepeat
+// keeps the last pressed key fresh, so this mostly hits modifiers held alone
+#define STUCK_KEY_CHECK_NS 1000000000ull
+
 bool is_modifier_key(int vk_code)
 {
     return vk_code == VK_SHIFT || vk_code == VK_CONTROL || 
@@ -80,58 +324,73 @@ bool is_modifier_key(int vk_code)
            vk_code == VK_RWIN;
 }
 
-std::string get_current_modifiers()
+static void init_key_state()
 {
-    std::string modifiers;
-    
-    if (GetAsyncKeyState(VK_CONTROL) & 0x8000) {
-        modifiers += "Ctrl + ";
-    }
-    if (GetAsyncKeyState(VK_MENU) & 0x8000) { // Alt key
-        modifiers += "Alt + ";
-    }
-    if (GetAsyncKeyState(VK_SHIFT) & 0x8000) {
-        modifiers += "Shift + ";
-    }
-    if (GetAsyncKeyState(VK_LWIN) & 0x8000 || GetAsyncKeyState(VK_RWIN) & 0x8000) {
-        modifiers += "Win + ";
-    }
-    
-    return modifiers;
+    static const uint32_t ctrl_keys[] = { VK_CONTROL, VK_LCONTROL, VK_RCONTROL };
+    static const uint32_t alt_keys[] = { VK_MENU, VK_LMENU, VK_RMENU };
+    static const uint32_t shift_keys[] = { VK_SHIFT, VK_LSHIFT, VK_RSHIFT };
+    static const uint32_t win_keys[] = { VK_LWIN, VK_RWIN };
+    static const key_state_modifier modifiers[] = {
+        { INPUT_MOD_CTRL, ctrl_keys, 3 },
+        { INPUT_MOD_ALT, alt_keys, 3 },
+        { INPUT_MOD_SHIFT, shift_keys, 3 },
+        { INPUT_MOD_WIN, win_keys, 2 },
+    };
+    key_state_init(&g_key_state, modifiers, 4);
 }
 
-bool matches_obs_source_target(keystroke_source* context, HWND current_hwnd, const char* current_window_title)
+static bool async_key_down(void* data, uint32_t code)
 {
-    if (context->capture_source_name.empty()) {
-        blog(LOG_WARNING, "[SOURCE-FILTER] No capture source specified");
-        return false;
+    UNUSED_PARAMETER(data);
+    return (GetAsyncKeyState((int)code) & 0x8000) != 0;
+}
+
+static uint64_t steady_now_ns()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Key-ups lost to a hook timeout or the secure desktop would otherwise leave
+// a modifier stuck on every later event. Only held keys are looked at.
+static void recover_stuck_keys(uint64_t now)
+{
+    if (key_state_recover(&g_key_state, now, STUCK_KEY_CHECK_NS, async_key_down, nullptr)) {
+        blog(LOG_DEBUG, "[INPUT] Released keys whose key-up was missed");
     }
+}
+
+// Modifiers come from the hook's key state as it was before this event
+static input_event make_input_event(uint32_t kind, uint32_t code, uint64_t timestamp)
+{
+    input_event event;
+    event.code = code;
+    event.flags = kind | key_state_modifiers(&g_key_state);
+    event.timestamp = timestamp;
+    return event;
+}
+
+bool matches_obs_source_target(keystroke_source* context, const capture_settings* settings,
+    const foreground_window_info* info)
+{
+    HWND current_hwnd = (HWND)info->id;
+    const char* current_window_title = info->title;
     
-    // Find the OBS source by name
-    obs_source_t* source = obs_get_source_by_name(context->capture_source_name.c_str());
-    if (!source) {
-        blog(LOG_WARNING, "[SOURCE-FILTER] Source '%s' not found", context->capture_source_name.c_str());
+    // Prebuilt by the resolver - no libobs calls on the hook path
+    auto target = source_target_get(&context->capture_target);
+    if (!target) {
+        blog(LOG_WARNING, "[SOURCE-FILTER] Source '%s' not resolved", settings->capture_source_name.c_str());
         return false;
     }
     
-    // Get source ID to determine type
-    const char* source_id = obs_source_get_id(source);
-    obs_data_t* settings = obs_source_get_settings(source);
     bool matches = false;
     
-    blog(LOG_INFO, "[SOURCE-FILTER] Checking source '%s' (type: %s)", 
-         context->capture_source_name.c_str(), source_id);
-    
-    // Log all settings for debugging
-    const char* json = obs_data_get_json(settings);
-    blog(LOG_INFO, "[SOURCE-FILTER] Source settings: %s", json);
-    
-    if (strcmp(source_id, "monitor_capture") == 0) {
+    if (target->kind == SOURCE_TARGET_MONITOR) {
         // Display Capture - check if current window is on the captured monitor
         // OBS uses "monitor_id" (device string) not "monitor" (integer index)
-        const char* monitor_id = obs_data_get_string(settings, "monitor_id");
+        const char* monitor_id = target->monitor_id.c_str();
         
-        if (!monitor_id || strlen(monitor_id) == 0) {
+        if (target->monitor_id.empty()) {
             blog(LOG_WARNING, "[SOURCE-FILTER] Display capture has no monitor_id");
             matches = false;
         } else {
@@ -199,261 +458,155 @@ bool matches_obs_source_target(keystroke_source* context, HWND current_hwnd, con
             }
         }
         
-    } else if (strcmp(source_id, "window_capture") == 0) {
+    } else if (target->kind == SOURCE_TARGET_WINDOW) {
         // Window Capture - check if current window matches the captured window
-        const char* target_window = obs_data_get_string(settings, "window");
+        // (snapshot title is already lowercased)
+        const std::string& target_title = target->title;
         
-        // OBS stores window format as: "title:class:exe"
-        // Extract just the title part for comparison
-        std::string target(target_window);
-        size_t colon_pos = target.find(':');
-        if (colon_pos != std::string::npos) {
-            target = target.substr(0, colon_pos);
-        }
-        
-        // Case-insensitive comparison
-        std::string current_title(current_window_title);
-        std::transform(target.begin(), target.end(), target.begin(), ::tolower);
-        std::transform(current_title.begin(), current_title.end(), current_title.begin(), ::tolower);
-        
-        matches = (current_title.find(target) != std::string::npos) || (target.find(current_title) != std::string::npos);
+        matches = matches_window_title(target_title, current_window_title);
         blog(LOG_INFO, "[SOURCE-FILTER] Window capture: target='%s', current='%s', match=%s",
-             target.c_str(), current_window_title, matches ? "YES" : "NO");
+             target_title.c_str(), current_window_title, matches ? "YES" : "NO");
         
-    } else if (strcmp(source_id, "game_capture") == 0) {
+    } else if (target->kind == SOURCE_TARGET_GAME) {
         // Game Capture - check if current window matches the captured executable
-        const char* target_window = obs_data_get_string(settings, "window");
-        const char* capture_mode = obs_data_get_string(settings, "capture_mode");
+        const std::string& target_exe = target->exe;
         
-        // Extract executable name from OBS format "title:class:exe"
-        std::string target(target_window);
-        size_t last_colon = target.rfind(':');
-        std::string target_exe;
-        if (last_colon != std::string::npos) {
-            target_exe = target.substr(last_colon + 1);
-        }
-        
-        // Get current process executable name
-        DWORD process_id;
+        // Get current process executable name (cached per pid + start time)
+        DWORD process_id = 0;
         GetWindowThreadProcessId(current_hwnd, &process_id);
-        HANDLE hProcess = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, process_id);
-        char exe_path[MAX_PATH] = {0};
-        if (hProcess) {
-            DWORD size = MAX_PATH;
-            QueryFullProcessImageNameA(hProcess, 0, exe_path, &size);
-            CloseHandle(hProcess);
-        }
-        
-        // Extract just the executable name from full path
-        std::string current_exe(exe_path);
-        size_t last_slash = current_exe.rfind('\\');
-        if (last_slash != std::string::npos) {
-            current_exe = current_exe.substr(last_slash + 1);
-        }
-        
-        // Case-insensitive comparison
-        std::transform(target_exe.begin(), target_exe.end(), target_exe.begin(), ::tolower);
-        std::transform(current_exe.begin(), current_exe.end(), current_exe.begin(), ::tolower);
+        const char* exe = process_cache_lookup(&context->process_names,
+            &context->process_provider, (uint32_t)process_id);
+        std::string current_exe(exe ? exe : "");
         
         matches = (target_exe == current_exe);
         blog(LOG_INFO, "[SOURCE-FILTER] Game capture: target='%s', current='%s', match=%s",
              target_exe.c_str(), current_exe.c_str(), matches ? "YES" : "NO");
     }
     
-    obs_data_release(settings);
-    obs_source_release(source);
-    
     return matches;
 }
 
-bool should_capture_input(keystroke_source* context)
+// Snapshot of the focused window/control for the privacy guard
+static void read_focus_info(focus_info* info)
 {
-    // If area-based capture is disabled, always capture
-    if (!context->capture_area_only) {
-        return true;
-    }
+    memset(info, 0, sizeof(*info));
     
-    // Get foreground window
     HWND hwnd = GetForegroundWindow();
-    if (!hwnd) {
-        blog(LOG_WARNING, "[FILTER] No foreground window");
-        return false;
-    }
+    if (!hwnd)
+        return;
     
-    // Get window title (needed for both modes)
-    char window_title[256] = {0};
-    GetWindowTextA(hwnd, window_title, sizeof(window_title));
+    info->window_id = (uintptr_t)hwnd;
+    GetWindowTextA(hwnd, info->title, sizeof(info->title));
+    GetClassNameA(hwnd, info->window_class, sizeof(info->window_class));
     
-    // Check which filtering mode to use
-    if (context->use_source_capture) {
-        // OBS Source-based filtering
-        static bool logged_mode_once = false;
-        if (!logged_mode_once) {
-            blog(LOG_INFO, "[FILTER] Using OBS source capture mode: '%s'", 
-                 context->capture_source_name.c_str());
-            logged_mode_once = true;
-        }
-        
-        if (context->capture_source_name.empty()) {
-            blog(LOG_WARNING, "[FILTER] Source capture enabled but no source specified");
-            return false;
-        }
-        
-        bool matches = matches_obs_source_target(context, hwnd, window_title);
-        
-        // Log window changes (not every keystroke)
-        static std::string last_window_title;
-        static bool last_match_result = false;
-        
-        if (std::string(window_title) != last_window_title || matches != last_match_result) {
-            blog(LOG_INFO, "[FILTER] Window: '%s' | Source: '%s' | Match: %s", 
-                 window_title, context->capture_source_name.c_str(), matches ? "YES" : "NO");
-            last_window_title = window_title;
-            last_match_result = matches;
-        }
-        
-        return matches;
-        
-    } else {
-        // Traditional window title filtering
-        static bool logged_mode_once = false;
-        if (!logged_mode_once) {
-            blog(LOG_INFO, "[FILTER] Using window title filtering mode");
-            logged_mode_once = true;
-        }
-        
-        // If no target window specified, capture from all windows when enabled
-        if (context->target_window.empty()) {
-            static bool logged_once = false;
-            if (!logged_once) {
-                blog(LOG_INFO, "[FILTER] Window filtering enabled but no target specified - capturing all windows");
-                logged_once = true;
-            }
-            return true;
-        }
-        
-        // Check if window title contains target string (case-insensitive partial match)
-        std::string title(window_title);
-        std::string target(context->target_window);
+    // GetFocus only reports this thread's focus - ask the foreground thread instead
+    GUITHREADINFO gui_info = {};
+    gui_info.cbSize = sizeof(GUITHREADINFO);
+    if (GetGUIThreadInfo(GetWindowThreadProcessId(hwnd, nullptr), &gui_info) && gui_info.hwndFocus) {
+        info->focus_id = (uintptr_t)gui_info.hwndFocus;
+        GetClassNameA(gui_info.hwndFocus, info->focus_class, sizeof(info->focus_class));
         
-        // Convert to lowercase for comparison
-        std::transform(title.begin(), title.end(), title.begin(), ::tolower);
-        std::transform(target.begin(), target.end(), target.begin(), ::tolower);
-        
-        // Return true if target is found in window title
-        bool matches = title.find(target) != std::string::npos;
-        
-        // Log window changes (not every keystroke)
-        static std::string last_window_title;
-        static bool last_match_result = false;
-        
-        if (title != last_window_title || matches != last_match_result) {
-            blog(LOG_INFO, "[FILTER] Window: '%s' | Target: '%s' | Match: %s", 
-                 window_title, context->target_window.c_str(), matches ? "YES" : "NO");
-            last_window_title = title;
-            last_match_result = matches;
+        // Check for password style on edit controls
+        if (strcmp(info->focus_class, "Edit") == 0) {
+            LONG style = GetWindowLong(gui_info.hwndFocus, GWL_STYLE);
+            info->password_style = (style & ES_PASSWORD) != 0;
         }
-        
-        return matches;
     }
 }
 
-bool is_password_field_active()
+// Hook thread: republish the foreground window snapshot
+static void refresh_foreground()
 {
-    // Get foreground window
+    auto foreground = std::make_shared<foreground_window_info>();
     HWND hwnd = GetForegroundWindow();
-    if (!hwnd)
-        return false;
+    foreground->id = (uintptr_t)hwnd;
+    foreground->title[0] = '\0';
+    if (hwnd) {
+        GetWindowTextA(hwnd, foreground->title, sizeof(foreground->title));
+    }
     
-    // Get focused control
-    HWND focused = GetFocus();
-    if (!focused)
+    std::atomic_store(&g_foreground, std::shared_ptr<const foreground_window_info>(foreground));
+    g_foreground_serial.fetch_add(1, std::memory_order_release);
+}
+
+static bool snapshot_get_foreground(void* data, foreground_window_info* info)
+{
+    UNUSED_PARAMETER(data);
+    
+    auto foreground = std::atomic_load(&g_foreground);
+    if (!foreground || !foreground->id)
         return false;
     
-    // Check window class for password indicators
-    char class_name[256] = {0};
-    GetClassNameA(focused, class_name, sizeof(class_name));
+    *info = *foreground;
+    return true;
+}
+
+static uint32_t snapshot_serial(void* data)
+{
+    UNUSED_PARAMETER(data);
+    return g_foreground_serial.load(std::memory_order_acquire);
+}
+
+// Window filter provider reading the snapshot; the live query if the
+// foreground and title events couldn't be hooked
+static window_info_provider foreground_provider()
+{
+    if (!g_foreground_event_hook || !g_name_event_hook)
+        return default_window_info_provider();
+    return { snapshot_get_foreground, snapshot_serial, nullptr };
+}
+
+// Foreground, focus and title changes drive the privacy guards and the
+// foreground snapshot
+static void CALLBACK focus_event_proc(HWINEVENTHOOK hook, DWORD event, HWND hwnd,
+    LONG id_object, LONG id_child, DWORD event_thread, DWORD event_time)
+{
+    UNUSED_PARAMETER(hook);
+    UNUSED_PARAMETER(id_child);
+    UNUSED_PARAMETER(event_thread);
+    UNUSED_PARAMETER(event_time);
     
-    // Check for edit control
-    if (strcmp(class_name, "Edit") == 0) {
-        // Check for password style
-        LONG style = GetWindowLong(focused, GWL_STYLE);
-        if (style & ES_PASSWORD) {
-            return true;
-        }
+    // Name changes fire for every object - only the foreground window title matters
+    if (event == EVENT_OBJECT_NAMECHANGE &&
+        (id_object != OBJID_WINDOW || hwnd != GetForegroundWindow())) {
+        return;
     }
     
-    // Additional checks for common password fields
-    char window_text[256] = {0};
-    GetWindowTextA(hwnd, window_text, sizeof(window_text));
-    std::string title(window_text);
-    
-    // Simple heuristic: check for password-related keywords
-    std::transform(title.begin(), title.end(), title.begin(), ::tolower);
-    if (title.find("password") != std::string::npos ||
-        title.find("login") != std::string::npos ||
-        title.find("sign in") != std::string::npos) {
-        return true;
+    if (event != EVENT_OBJECT_FOCUS) {
+        refresh_foreground();
     }
     
-    return false;
+    auto subscribers = std::atomic_load(&g_published);
+    if (subscribers) {
+        refresh_all_privacy_states(*subscribers);
+    }
 }
 
 LRESULT CALLBACK keyboard_hook_proc(int nCode, WPARAM wParam, LPARAM lParam)
 {
-    if (nCode >= 0 && g_context) {
+    if (nCode >= 0) {
         KBDLLHOOKSTRUCT* kbd = (KBDLLHOOKSTRUCT*)lParam;
+        uint64_t now = steady_now_ns();
+        recover_stuck_keys(now);
         
         if (wParam == WM_KEYDOWN || wParam == WM_SYSKEYDOWN) {
             int vk_code = kbd->vkCode;
             
-            blog(LOG_DEBUG, "[INPUT] Key pressed: VK=%d", vk_code);
-            
-            // Check if we should capture based on window filter
-            if (!should_capture_input(g_context)) {
-                blog(LOG_DEBUG, "[INPUT] Not in target window, ignoring");
-                return CallNextHookEx(g_keyboard_hook, nCode, wParam, lParam);
-            }
-            
-            // Check if we're in a password field
-            if (is_password_field_active()) {
-                blog(LOG_DEBUG, "[INPUT] Password field detected, ignoring keystroke");
-                return CallNextHookEx(g_keyboard_hook, nCode, wParam, lParam);
-            }
+            input_event event = make_input_event(INPUT_EVENT_KEY, (uint32_t)vk_code, now);
             
-            // Check if this is a modifier key alone
-            if (is_modifier_key(vk_code)) {
-                if (g_context->ignore_modifier_keys_alone) {
-                    g_pressed_keys.insert(vk_code);
-                    blog(LOG_DEBUG, "[INPUT] Modifier key alone, ignoring (setting enabled)");
-                    return CallNextHookEx(g_keyboard_hook, nCode, wParam, lParam);
-                }
-            }
-            
-            // Avoid duplicate events
-            if (g_pressed_keys.count(vk_code)) {
-                blog(LOG_DEBUG, "[INPUT] Duplicate key press, ignoring");
+            // Avoid duplicate events (autorepeat)
+            if (!key_state_press(&g_key_state, (uint32_t)vk_code, now)) {
                 return CallNextHookEx(g_keyboard_hook, nCode, wParam, lParam);
             }
-            g_pressed_keys.insert(vk_code);
-            
-            // Get modifiers
-            std::string modifiers = get_current_modifiers();
-            
-            // Get key name
-            bool shift_pressed = (GetAsyncKeyState(VK_SHIFT) & 0x8000) != 0;
-            std::string key_name = get_key_name(vk_code, shift_pressed);
             
-            if (!key_name.empty()) {
-                std::string full_key = modifiers + key_name;
-                blog(LOG_INFO, "[INPUT] Adding keystroke: '%s'", full_key.c_str());
-                add_keystroke(g_context, full_key);
-            } else {
-                blog(LOG_DEBUG, "[INPUT] Key name empty for VK=%d", vk_code);
+            // Hand off to the video threads - naming and history updates happen there
+            auto subscribers = std::atomic_load(&g_published);
+            if (subscribers) {
+                dispatch_event(*subscribers, event);
             }
         }
         else if (wParam == WM_KEYUP || wParam == WM_SYSKEYUP) {
-            g_pressed_keys.erase(kbd->vkCode);
+            key_state_release(&g_key_state, kbd->vkCode);
         }
     }
     
@@ -462,74 +615,357 @@ LRESULT CALLBACK keyboard_hook_proc(int nCode, WPARAM wParam, LPARAM lParam)
 
 LRESULT CALLBACK mouse_hook_proc(int nCode, WPARAM wParam, LPARAM lParam)
 {
-    if (nCode >= 0 && g_context && g_context->show_mouse_clicks) {
-        // Check if we should capture based on window filter
-        if (!should_capture_input(g_context)) {
-            return CallNextHookEx(g_mouse_hook, nCode, wParam, lParam);
-        }
-        
-        std::string mouse_action;
+    if (nCode >= 0) {
+        uint32_t kind = 0;
+        uint32_t code = 0;
         
         switch (wParam) {
             case WM_LBUTTONDOWN:
-                mouse_action = "Left Click";
+                kind = INPUT_EVENT_MOUSE_BUTTON;
+                code = INPUT_MOUSE_LEFT;
                 break;
             case WM_RBUTTONDOWN:
-                mouse_action = "Right Click";
+                kind = INPUT_EVENT_MOUSE_BUTTON;
+                code = INPUT_MOUSE_RIGHT;
                 break;
             case WM_MBUTTONDOWN:
-                mouse_action = "Middle Click";
+                kind = INPUT_EVENT_MOUSE_BUTTON;
+                code = INPUT_MOUSE_MIDDLE;
                 break;
             case WM_XBUTTONDOWN:
-                mouse_action = "Mouse Button";
+                kind = INPUT_EVENT_MOUSE_BUTTON;
+                code = INPUT_MOUSE_X;
                 break;
             case WM_MOUSEWHEEL: {
                 MSLLHOOKSTRUCT* mouse = (MSLLHOOKSTRUCT*)lParam;
                 short delta = GET_WHEEL_DELTA_WPARAM(mouse->mouseData);
-                if (delta > 0) {
-                    mouse_action = "Scroll Up";
-                } else if (delta < 0) {
-                    mouse_action = "Scroll Down";
+                if (delta != 0) {
+                    kind = INPUT_EVENT_MOUSE_WHEEL;
+                    code = delta > 0 ? INPUT_WHEEL_UP : INPUT_WHEEL_DOWN;
                 }
                 break;
             }
         }
         
-        if (!mouse_action.empty()) {
-            // Check for modifiers
-            std::string modifiers = get_current_modifiers();
-            blog(LOG_INFO, "[INPUT] Adding mouse action: '%s'", (modifiers + mouse_action).c_str());
-            add_keystroke(g_context, modifiers + mouse_action);
+        // Mouse moves are by far the most frequent event - bail out before
+        // taking the lock or touching the window filters
+        if (kind != 0) {
+            uint64_t now = steady_now_ns();
+            recover_stuck_keys(now);
+            
+            auto subscribers = std::atomic_load(&g_published);
+            if (subscribers) {
+                dispatch_event(*subscribers, make_input_event(kind, code, now));
+            }
         }
     }
     
     return CallNextHookEx(g_mouse_hook, nCode, wParam, lParam);
 }
 
+static void install_hooks()
+{
+    g_keyboard_hook = SetWindowsHookEx(WH_KEYBOARD_LL, keyboard_hook_proc, 
+                                      GetModuleHandle(nullptr), 0);
+    if (g_keyboard_hook) {
+        blog(LOG_INFO, "Keyboard hook installed successfully");
+    } else {
+        blog(LOG_ERROR, "Failed to install keyboard hook");
+    }
+    
+    g_mouse_hook = SetWindowsHookEx(WH_MOUSE_LL, mouse_hook_proc,
+                                   GetModuleHandle(nullptr), 0);
+    if (g_mouse_hook) {
+        blog(LOG_INFO, "Mouse hook installed successfully");
+    } else {
+        blog(LOG_ERROR, "Failed to install mouse hook");
+    }
+    
+    // Focus tracking for the privacy guards (delivered on this thread, like the hooks)
+    g_foreground_event_hook = SetWinEventHook(EVENT_SYSTEM_FOREGROUND, EVENT_SYSTEM_FOREGROUND,
+        nullptr, focus_event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    g_focus_event_hook = SetWinEventHook(EVENT_OBJECT_FOCUS, EVENT_OBJECT_FOCUS,
+        nullptr, focus_event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    g_name_event_hook = SetWinEventHook(EVENT_OBJECT_NAMECHANGE, EVENT_OBJECT_NAMECHANGE,
+        nullptr, focus_event_proc, 0, 0, WINEVENT_OUTOFCONTEXT);
+    if (!g_foreground_event_hook || !g_focus_event_hook || !g_name_event_hook) {
+        blog(LOG_WARNING, "Failed to install focus event hooks, privacy state refreshes on rule changes only");
+    }
+}
+
+static void remove_hooks()
+{
+    if (g_keyboard_hook) {
+        UnhookWindowsHookEx(g_keyboard_hook);
+        g_keyboard_hook = nullptr;
+        blog(LOG_INFO, "Keyboard hook removed");
+    }
+    
+    if (g_mouse_hook) {
+        UnhookWindowsHookEx(g_mouse_hook);
+        g_mouse_hook = nullptr;
+        blog(LOG_INFO, "Mouse hook removed");
+    }
+    
+    HWINEVENTHOOK* event_hooks[] = { &g_foreground_event_hook, &g_focus_event_hook, &g_name_event_hook };
+    for (HWINEVENTHOOK* event_hook : event_hooks) {
+        if (*event_hook) {
+            UnhookWinEvent(*event_hook);
+            *event_hook = nullptr;
+        }
+    }
+}
+
+// Low-level hooks are called on the thread that installed them, and only
+// while it pumps messages. A thread of our own keeps them off the graphics
+// thread, whose frame times would otherwise delay every key and mouse event.
+static void hook_thread_main(std::promise<void> ready)
+{
+    // Create the message queue before anyone can post WM_QUIT to it
+    MSG msg;
+    PeekMessage(&msg, nullptr, WM_USER, WM_USER, PM_NOREMOVE);
+    g_hook_thread_id = GetCurrentThreadId();
+    
+    init_key_state();
+    install_hooks();
+    refresh_foreground();
+    ready.set_value();
+    
+    while (GetMessage(&msg, nullptr, 0, 0) > 0) {
+        TranslateMessage(&msg);
+        DispatchMessage(&msg);
+    }
+    
+    remove_hooks();
+    blog(LOG_INFO, "[INPUT] Autorepeats ignored: %llu, stuck keys recovered: %llu",
+         (unsigned long long)g_key_state.repeats,
+         (unsigned long long)g_key_state.recovered);
+}
+
 void start_input_capture(keystroke_source* context)
 {
     if (!context)
         return;
     
-    g_context = context;
+    std::lock_guard<std::mutex> service_lock(g_service_mutex);
     
-    if (!g_keyboard_hook) {
-        g_keyboard_hook = SetWindowsHookEx(WH_KEYBOARD_LL, keyboard_hook_proc, 
-                                          GetModuleHandle(nullptr), 0);
-        if (g_keyboard_hook) {
-            blog(LOG_INFO, "Keyboard hook installed successfully");
-        } else {
-            blog(LOG_ERROR, "Failed to install keyboard hook");
+    // The first source starts the hook thread, which serves every source
+    // started later
+    if (!g_hook_thread.joinable()) {
+        std::promise<void> ready;
+        std::future<void> started = ready.get_future();
+        g_hook_thread = std::thread(hook_thread_main, std::move(ready));
+        started.wait();
+    }
+    
+    // Set up before the hooks can see the source. Decisions cached against
+    // another provider's serial don't carry over.
+    context->window_provider = foreground_provider();
+    filter_cache_invalidate(&context->window_filter);
+    subscribe(context);
+    
+    context->is_capturing = true;
+}
+
+void stop_input_capture(keystroke_source* context)
+{
+    if (!context)
+        return;
+    
+    std::lock_guard<std::mutex> service_lock(g_service_mutex);
+    
+    if (unsubscribe(context) && g_hook_thread.joinable()) {
+        PostThreadMessage(g_hook_thread_id, WM_QUIT, 0, 0);
+        g_hook_thread.join();
+        g_hook_thread_id = 0;
+    }
+    context->window_provider = default_window_info_provider();
+    
+    log_capture_stats(context);
+    context->is_capturing = false;
+}
+
+#elif defined(__linux__)
+#include "evdev-reader.h"
+#include "x11-window-tracker.h"
+#include <linux/input-event-codes.h>
+
+// Linux: evdev devices read on their own thread. Event codes are KEY_* / BTN_*
+// values rather than virtual keys; everything after the queue is shared.
+// The active window comes from X11 when there is an X server.
+static evdev_reader* g_reader = nullptr;
+static x11_window_tracker* g_window_tracker = nullptr; // nullptr without X11
+static uint32_t g_focus_serial = 0; // Tracker serial the privacy guards last saw (reader thread)
+static key_state g_key_state; // Reader thread
+
+// INPUT_MOD_* flag of a modifier key, 0 for anything else
+static uint32_t modifier_flag(int code)
+{
+    switch (code) {
+        case KEY_LEFTCTRL: case KEY_RIGHTCTRL: return INPUT_MOD_CTRL;
+        case KEY_LEFTALT: case KEY_RIGHTALT: return INPUT_MOD_ALT;
+        case KEY_LEFTSHIFT: case KEY_RIGHTSHIFT: return INPUT_MOD_SHIFT;
+        case KEY_LEFTMETA: case KEY_RIGHTMETA: return INPUT_MOD_WIN;
+    }
+    return 0;
+}
+
+bool is_modifier_key(int vk_code)
+{
+    return modifier_flag(vk_code) != 0;
+}
+
+static uint32_t mouse_button(int code)
+{
+    switch (code) {
+        case BTN_LEFT: return INPUT_MOUSE_LEFT;
+        case BTN_RIGHT: return INPUT_MOUSE_RIGHT;
+        case BTN_MIDDLE: return INPUT_MOUSE_MIDDLE;
+        case BTN_SIDE: case BTN_EXTRA: return INPUT_MOUSE_X;
+    }
+    return 0;
+}
+
+static void init_key_state()
+{
+    static const uint32_t ctrl_keys[] = { KEY_LEFTCTRL, KEY_RIGHTCTRL };
+    static const uint32_t alt_keys[] = { KEY_LEFTALT, KEY_RIGHTALT };
+    static const uint32_t shift_keys[] = { KEY_LEFTSHIFT, KEY_RIGHTSHIFT };
+    static const uint32_t win_keys[] = { KEY_LEFTMETA, KEY_RIGHTMETA };
+    static const key_state_modifier modifiers[] = {
+        { INPUT_MOD_CTRL, ctrl_keys, 2 },
+        { INPUT_MOD_ALT, alt_keys, 2 },
+        { INPUT_MOD_SHIFT, shift_keys, 2 },
+        { INPUT_MOD_WIN, win_keys, 2 },
+    };
+    key_state_init(&g_key_state, modifiers, 4);
+}
+
+// Source-mode filtering can only follow window captures here: the active
+// window's title against the one xcomposite_input captures
+bool matches_obs_source_target(keystroke_source* context, const capture_settings* settings,
+    const foreground_window_info* info)
+{
+    auto target = source_target_get(&context->capture_target);
+    if (!target) {
+        blog(LOG_WARNING, "[SOURCE-FILTER] Source '%s' not resolved", settings->capture_source_name.c_str());
+        return false;
+    }
+    
+    if (target->kind != SOURCE_TARGET_WINDOW) {
+        blog(LOG_WARNING, "[SOURCE-FILTER] Only window capture sources can be followed on Linux");
+        return false;
+    }
+    
+    bool matches = matches_window_title(target->title, info->title);
+    blog(LOG_INFO, "[SOURCE-FILTER] Window capture: target='%s', current='%s', match=%s",
+         target->title.c_str(), info->title, matches ? "YES" : "NO");
+    return matches;
+}
+
+// Focus snapshot from the tracker. X11 doesn't expose the focused control,
+// so only title keywords and window classes apply.
+static void read_focus_info(focus_info* info)
+{
+    memset(info, 0, sizeof(*info));
+    
+    if (g_window_tracker) {
+        auto window = x11_window_tracker_get(g_window_tracker);
+        info->window_id = window->window;
+        snprintf(info->title, sizeof(info->title), "%s", window->title.c_str());
+        snprintf(info->window_class, sizeof(info->window_class), "%s", window->window_class.c_str());
+    }
+}
+
+static input_event make_input_event(uint32_t kind, uint32_t code,
+    uint32_t modifiers, uint64_t timestamp)
+{
+    input_event event;
+    event.code = code;
+    event.flags = kind | modifiers;
+    event.timestamp = timestamp;
+    return event;
+}
+
+// Reader thread: one batch of evdev records -> queued input events
+static void evdev_batch(void* data, const evdev_event* events, size_t count)
+{
+    UNUSED_PARAMETER(data);
+    
+    auto subscribers = std::atomic_load(&g_published);
+    if (!subscribers)
+        return;
+    
+    // Reading the serial is all a batch costs while focus stays put
+    uint32_t focus_serial = g_window_tracker ? x11_window_tracker_serial(g_window_tracker) : 0;
+    if (focus_serial != g_focus_serial) {
+        refresh_all_privacy_states(*subscribers);
+        g_focus_serial = focus_serial;
+    }
+    
+    for (size_t i = 0; i < count; i++) {
+        const evdev_event& e = events[i];
+        
+        if (e.type == EV_SYN && e.code == SYN_DROPPED) {
+            // The kernel buffer overflowed and key-ups may be gone. Releasing
+            // everything is the safe side: a missed modifier only drops a
+            // prefix, a stuck one would decorate every later key.
+            key_state_clear(&g_key_state);
+            blog(LOG_DEBUG, "[INPUT] evdev events dropped, key state reset");
+        } else if (e.type == EV_KEY) {
+            // Modifier state as it was before this key, like the Windows hook
+            uint32_t modifiers = key_state_modifiers(&g_key_state);
+            if (e.value) {
+                key_state_press(&g_key_state, e.code, e.timestamp);
+            } else {
+                key_state_release(&g_key_state, e.code);
+            }
+            
+            // Releases and autorepeat (the hook's duplicate presses) are not shown
+            if (e.value != 1)
+                continue;
+            
+            uint32_t button = mouse_button(e.code);
+            if (button) {
+                dispatch_event(*subscribers, make_input_event(INPUT_EVENT_MOUSE_BUTTON, button, modifiers, e.timestamp));
+            } else {
+                dispatch_event(*subscribers, make_input_event(INPUT_EVENT_KEY, e.code, modifiers, e.timestamp));
+            }
+        } else if (e.type == EV_REL && e.code == REL_WHEEL && e.value != 0) {
+            dispatch_event(*subscribers, make_input_event(INPUT_EVENT_MOUSE_WHEEL,
+                e.value > 0 ? INPUT_WHEEL_UP : INPUT_WHEEL_DOWN, key_state_modifiers(&g_key_state), e.timestamp));
+        }
+    }
+}
+
+void start_input_capture(keystroke_source* context)
+{
+    if (!context)
+        return;
+    
+    std::lock_guard<std::mutex> service_lock(g_service_mutex);
+    
+    // Area-only capture needs the active window; without X11 it never matches
+    if (!g_window_tracker) {
+        g_window_tracker = x11_window_tracker_create(nullptr);
+        if (!g_window_tracker) {
+            blog(LOG_WARNING, "No X11 active window tracking, window filtering disabled");
         }
     }
+    if (g_window_tracker) {
+        context->window_provider = x11_window_tracker_provider(g_window_tracker);
+    }
+    // Decisions cached against another provider's serial don't carry over
+    filter_cache_invalidate(&context->window_filter);
     
-    if (!g_mouse_hook) {
-        g_mouse_hook = SetWindowsHookEx(WH_MOUSE_LL, mouse_hook_proc,
-                                       GetModuleHandle(nullptr), 0);
-        if (g_mouse_hook) {
-            blog(LOG_INFO, "Mouse hook installed successfully");
+    if (subscribe(context)) {
+        init_key_state();
+        g_reader = evdev_reader_create(evdev_batch, nullptr);
+        size_t devices = g_reader ? evdev_reader_open_devices(g_reader) : 0;
+        if (devices > 0 && evdev_reader_start(g_reader)) {
+            blog(LOG_INFO, "evdev input capture started on %zu devices", devices);
         } else {
-            blog(LOG_ERROR, "Failed to install mouse hook");
+            blog(LOG_WARNING, "No readable keyboard or mouse devices, input capture disabled");
         }
     }
     
@@ -541,46 +977,84 @@ void stop_input_capture(keystroke_source* context)
     if (!context)
         return;
     
-    if (g_keyboard_hook) {
-        UnhookWindowsHookEx(g_keyboard_hook);
-        g_keyboard_hook = nullptr;
-        blog(LOG_INFO, "Keyboard hook removed");
-    }
+    std::lock_guard<std::mutex> service_lock(g_service_mutex);
     
-    if (g_mouse_hook) {
-        UnhookWindowsHookEx(g_mouse_hook);
-        g_mouse_hook = nullptr;
-        blog(LOG_INFO, "Mouse hook removed");
+    if (unsubscribe(context)) {
+        evdev_reader_destroy(g_reader);
+        g_reader = nullptr;
+        
+        x11_window_tracker_destroy(g_window_tracker);
+        g_window_tracker = nullptr;
+        g_focus_serial = 0;
     }
+    context->window_provider = default_window_info_provider();
     
-    g_context = nullptr;
+    log_capture_stats(context);
     context->is_capturing = false;
-    g_pressed_keys.clear();
 }
 
 #else
-// Non-Windows platforms (stub implementation)
+// Other platforms (stub implementation)
 void start_input_capture(keystroke_source* context)
 {
     blog(LOG_WARNING, "Input capture not implemented for this platform");
+    context->is_capturing = true; // Don't retry every tick
 }
 
 void stop_input_capture(keystroke_source* context)
 {
+    context->is_capturing = false;
 }
 
-std::string get_key_name(int vk_code, bool shift_pressed)
+bool is_modifier_key(int vk_code)
 {
-    return "";
+    UNUSED_PARAMETER(vk_code);
+    return false;
 }
 
-bool is_password_field_active()
+void input_capture_filter_changed(keystroke_source* context)
 {
-    return false;
+    UNUSED_PARAMETER(context);
 }
+#endif
 
-bool is_modifier_key(int vk_code)
+void drain_input_events(keystroke_source* context)
 {
-    return false;
+    input_event batch[64];
+    size_t count;
+    
+    while ((count = input_queue_drain(&context->input_events, batch, 64)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            key_label_id label = key_label_for_event(batch[i]);
+            if (label == KEY_LABEL_NONE) {
+                blog(LOG_DEBUG, "[INPUT] No label for event code=%u", batch[i].code);
+                continue;
+            }
+            
+            // Redact secrets before they ever reach the history
+            const key_label& stroke = key_label_get(label);
+            redactor_result redaction = secret_redactor_feed(&context->redactor, stroke.input, stroke.typed);
+            if (redaction.retro_mask > 0) {
+                mask_recent_digits(context, redaction.retro_mask);
+            }
+            if (redaction.mask) {
+                label = key_label_masked();
+            }
+            
+            auto when = std::chrono::steady_clock::time_point(
+                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::nanoseconds(batch[i].timestamp)));
+            
+            add_keystroke(context, label, when);
+        }
+    }
+    
+    // Surface ring overflows once per change rather than per dropped event
+    uint64_t dropped = context->input_events.dropped.load(std::memory_order_relaxed);
+    if (dropped != context->reported_input_drops) {
+        blog(LOG_WARNING, "[INPUT] Event queue full: %llu events dropped in %llu overflows",
+             (unsigned long long)dropped,
+             (unsigned long long)context->input_events.overflows.load(std::memory_order_relaxed));
+        context->reported_input_drops = dropped;
+    }
 }
-#endif
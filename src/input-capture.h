@@ -3,16 +3,21 @@
 #include "keystroke-source.h"
 #include <string>
 
-// Windows-specific input capture using low-level keyboard and mouse hooks
+// Input capture: low-level keyboard and mouse hooks on Windows, evdev devices on Linux
 #ifdef _WIN32
 #include <Windows.h>
 #endif
 
-// Input capture management
+// Input capture management. Every started source subscribes to one
+// process-wide set of hooks; the hooks go away with the last source.
 void start_input_capture(keystroke_source* context);
 void stop_input_capture(keystroke_source* context);
 
-// Helper functions
-std::string get_key_name(int vk_code, bool shift_pressed);
-bool is_password_field_active();
+// Re-group a started source after its window filter settings changed
+void input_capture_filter_changed(keystroke_source* context);
+
+// Move queued hook events into the keystroke history (video thread only)
+void drain_input_events(keystroke_source* context);
+
+// Key codes are virtual keys on Windows, evdev KEY_* on Linux (names: key-names.h)
 bool is_modifier_key(int vk_code);
@@ -0,0 +1,80 @@
+#include "input-queue.h"
+
+// Bounded ring based on per-cell sequence numbers (Vyukov). A cell is free for
+// the producer at position pos when sequence == pos, and holds an event for
+// the consumer when sequence == pos + 1.
+
+static_assert((INPUT_QUEUE_CAPACITY & (INPUT_QUEUE_CAPACITY - 1)) == 0,
+    "INPUT_QUEUE_CAPACITY must be a power of two");
+
+static const size_t queue_mask = INPUT_QUEUE_CAPACITY - 1;
+
+void input_queue_init(input_queue* queue)
+{
+    for (size_t i = 0; i < INPUT_QUEUE_CAPACITY; i++) {
+        queue->cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    queue->enqueue_pos.store(0, std::memory_order_relaxed);
+    queue->dequeue_pos = 0;
+    queue->dropped.store(0, std::memory_order_relaxed);
+    queue->overflows.store(0, std::memory_order_relaxed);
+    queue->full.store(false, std::memory_order_release);
+}
+
+bool input_queue_push(input_queue* queue, const input_event& event)
+{
+    size_t pos = queue->enqueue_pos.load(std::memory_order_relaxed);
+
+    for (;;) {
+        input_queue_cell* cell = &queue->cells[pos & queue_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+        if (diff == 0) {
+            // Slot is free - try to claim it
+            if (queue->enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                    std::memory_order_relaxed)) {
+                cell->event = event;
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            // Consumer hasn't caught up - ring is full, drop the event
+            queue->dropped.fetch_add(1, std::memory_order_relaxed);
+            if (!queue->full.exchange(true, std::memory_order_relaxed)) {
+                queue->overflows.fetch_add(1, std::memory_order_relaxed);
+            }
+            return false;
+        } else {
+            // Another producer claimed this slot first
+            pos = queue->enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+size_t input_queue_drain(input_queue* queue, input_event* out, size_t max_events)
+{
+    size_t count = 0;
+    size_t pos = queue->dequeue_pos;
+
+    while (count < max_events) {
+        input_queue_cell* cell = &queue->cells[pos & queue_mask];
+        size_t seq = cell->sequence.load(std::memory_order_acquire);
+
+        if ((intptr_t)seq - (intptr_t)(pos + 1) < 0) {
+            break; // Empty (or producer still writing this slot)
+        }
+
+        out[count++] = cell->event;
+        cell->sequence.store(pos + INPUT_QUEUE_CAPACITY, std::memory_order_release);
+        pos++;
+    }
+
+    queue->dequeue_pos = pos;
+
+    if (count > 0) {
+        queue->full.store(false, std::memory_order_relaxed);
+    }
+
+    return count;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Number of slots in the hook -> video thread ring (must be a power of two)
+#define INPUT_QUEUE_CAPACITY 1024
+
+// Event kind, stored in the low byte of input_event::flags
+enum input_event_kind : uint32_t {
+    INPUT_EVENT_KEY = 1,          // code = virtual key (Windows) or evdev KEY_* code
+    INPUT_EVENT_MOUSE_BUTTON = 2, // code = input_mouse_button
+    INPUT_EVENT_MOUSE_WHEEL = 3,  // code = input_wheel_direction
+};
+
+// Modifier state at the time the hook fired, stored in input_event::flags
+enum input_event_modifier : uint32_t {
+    INPUT_MOD_CTRL = 1 << 8,
+    INPUT_MOD_ALT = 1 << 9,
+    INPUT_MOD_SHIFT = 1 << 10,
+    INPUT_MOD_WIN = 1 << 11,
+};
+
+enum input_mouse_button : uint32_t {
+    INPUT_MOUSE_LEFT = 1,
+    INPUT_MOUSE_RIGHT = 2,
+    INPUT_MOUSE_MIDDLE = 3,
+    INPUT_MOUSE_X = 4,
+};
+
+enum input_wheel_direction : uint32_t {
+    INPUT_WHEEL_UP = 1,
+    INPUT_WHEEL_DOWN = 2,
+};
+
+#define INPUT_EVENT_KIND_MASK 0xFFu
+
+// Fixed-size record pushed by the input hooks. Must stay trivially copyable:
+// the hooks never allocate, they only copy one of these into the ring.
+struct input_event {
+    uint32_t code;
+    uint32_t flags;      // input_event_kind | input_event_modifier bits
+    uint64_t timestamp;  // steady_clock nanoseconds when the hook fired
+};
+
+static_assert(std::is_trivially_copyable<input_event>::value,
+    "input_event must be POD so the hook can push it without allocating");
+
+struct input_queue_cell {
+    std::atomic<size_t> sequence;
+    input_event event;
+};
+
+// Bounded lock-free multi-producer / single-consumer ring.
+// Producers are the input hooks, the consumer is keystroke_source_tick.
+struct input_queue {
+    input_queue_cell cells[INPUT_QUEUE_CAPACITY];
+    alignas(64) std::atomic<size_t> enqueue_pos;
+    alignas(64) size_t dequeue_pos; // consumer only
+
+    // Diagnostics
+    std::atomic<uint64_t> dropped;   // events lost because the ring was full
+    std::atomic<uint64_t> overflows; // times the ring transitioned to full
+    std::atomic<bool> full;
+};
+
+void input_queue_init(input_queue* queue);
+
+// Hook side: never blocks. Returns false (and counts a drop) if the ring is full.
+bool input_queue_push(input_queue* queue, const input_event& event);
+
+// Consumer side: moves up to max_events events into out, returns how many.
+size_t input_queue_drain(input_queue* queue, input_event* out, size_t max_events);
@@ -0,0 +1,173 @@
+#include "key-labels.h"
+#include "key-names.h"
+#include <cctype>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+// Event kind 0 never comes from a hook, so it can't collide with real keys
+#define MASKED_LABEL_KEY 0
+
+static const uint32_t label_flag_mask = INPUT_EVENT_KIND_MASK |
+    INPUT_MOD_CTRL | INPUT_MOD_ALT | INPUT_MOD_SHIFT | INPUT_MOD_WIN;
+
+struct label_table {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, key_label_id> ids;  // (layout << 44 | flags << 32 | code) -> id
+    std::deque<key_label> labels;                    // labels[id - 1]; deque keeps references stable
+};
+
+static label_table& get_table()
+{
+    static label_table table;
+    return table;
+}
+
+// Key name or mouse action of an event ("A", "Enter", "Left Click", ...)
+static std::string get_event_action(const input_event& event, uint32_t layout)
+{
+    std::string action;
+
+    switch (event.flags & INPUT_EVENT_KIND_MASK) {
+        case INPUT_EVENT_KEY:
+            action = key_name(layout, event.code, (event.flags & INPUT_MOD_SHIFT) != 0);
+            break;
+        case INPUT_EVENT_MOUSE_BUTTON:
+            switch (event.code) {
+                case INPUT_MOUSE_LEFT: action = "Left Click"; break;
+                case INPUT_MOUSE_RIGHT: action = "Right Click"; break;
+                case INPUT_MOUSE_MIDDLE: action = "Middle Click"; break;
+                case INPUT_MOUSE_X: action = "Mouse Button"; break;
+            }
+            break;
+        case INPUT_EVENT_MOUSE_WHEEL:
+            action = event.code == INPUT_WHEEL_UP ? "Scroll Up" : "Scroll Down";
+            break;
+    }
+
+    return action;
+}
+
+static std::string format_modifiers(uint32_t flags)
+{
+    std::string modifiers;
+    if (flags & INPUT_MOD_CTRL) {
+        modifiers += "Ctrl + ";
+    }
+    if (flags & INPUT_MOD_ALT) {
+        modifiers += "Alt + ";
+    }
+    if (flags & INPUT_MOD_SHIFT) {
+        modifiers += "Shift + ";
+    }
+    if (flags & INPUT_MOD_WIN) {
+        modifiers += "Win + ";
+    }
+    return modifiers;
+}
+
+// One UTF-8 encoded codepoint
+static bool is_single_character(const std::string& text)
+{
+    if (text.empty())
+        return false;
+
+    unsigned char lead = (unsigned char)text[0];
+    size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    return text.size() == length;
+}
+
+// How an event continues (or breaks) the typed text seen by the secret redactor
+static void classify_typed_input(const input_event& event, const std::string& action, key_label* label)
+{
+    label->typed = 0;
+    label->input = REDACTOR_OTHER;
+
+    if ((event.flags & INPUT_EVENT_KIND_MASK) != INPUT_EVENT_KEY ||
+        (event.flags & (INPUT_MOD_CTRL | INPUT_MOD_ALT | INPUT_MOD_WIN))) {
+        return;
+    }
+
+    if (is_single_character(action)) {
+        // Non-ASCII characters only need to keep a masked line masked and
+        // break digit runs, so their lead byte stands in for them
+        label->typed = action[0];
+        label->input = REDACTOR_CHAR;
+    } else if (action == "Space") {
+        label->typed = ' ';
+        label->input = REDACTOR_CHAR;
+    } else if (action == "Enter" || action == "Tab" || action == "Esc") {
+        label->input = REDACTOR_LINE_END;
+    } else if (action == "Backspace") {
+        label->input = REDACTOR_BACKSPACE;
+    }
+}
+
+// Caller holds the table mutex
+static key_label_id add_label(label_table* table, uint64_t key, key_label label)
+{
+    table->labels.push_back(std::move(label));
+    key_label_id id = (key_label_id)table->labels.size();
+    table->ids.emplace(key, id);
+    return id;
+}
+
+key_label_id key_label_for_event(const input_event& event)
+{
+    // Only key names depend on the keyboard layout
+    uint32_t flags = event.flags & label_flag_mask;
+    uint32_t layout = (flags & INPUT_EVENT_KIND_MASK) == INPUT_EVENT_KEY ? key_layout_current() : 0;
+    uint64_t key = ((uint64_t)layout << 44) | ((uint64_t)flags << 32) | event.code;
+
+    label_table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto it = table.ids.find(key);
+    if (it != table.ids.end())
+        return it->second;
+
+    // Unnamed keys are remembered too, so they aren't formatted again
+    std::string action = get_event_action(event, layout);
+    if (action.empty()) {
+        table.ids.emplace(key, KEY_LABEL_NONE);
+        return KEY_LABEL_NONE;
+    }
+
+    key_label label;
+    label.text = format_modifiers(flags);
+    label.key_offset = (uint32_t)label.text.size();
+    label.text += action;
+    label.kind = flags & INPUT_EVENT_KIND_MASK;
+    label.modifiers = flags & ~INPUT_EVENT_KIND_MASK;
+    classify_typed_input(event, action, &label);
+    label.groupable = (flags & ~INPUT_EVENT_KIND_MASK) == 0 && is_single_character(action) &&
+        (isalnum((unsigned char)action[0]) || (unsigned char)action[0] >= 0x80);
+    return add_label(&table, key, std::move(label));
+}
+
+key_label_id key_label_masked()
+{
+    label_table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+
+    auto it = table.ids.find(MASKED_LABEL_KEY);
+    if (it != table.ids.end())
+        return it->second;
+
+    key_label label;
+    label.text = "*";
+    label.kind = INPUT_EVENT_KEY;
+    label.modifiers = 0;
+    label.key_offset = 0;
+    label.typed = '*';
+    label.input = REDACTOR_CHAR;
+    label.groupable = true;
+    return add_label(&table, MASKED_LABEL_KEY, std::move(label));
+}
+
+const key_label& key_label_get(key_label_id id)
+{
+    label_table& table = get_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    return table.labels[id - 1];
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "input-queue.h"
+#include "secret-redactor.h"
+#include <cstdint>
+#include <string>
+
+// Interned display label id. Every distinct (kind, code, modifiers) an event
+// can carry maps to one id for the life of the process, so the history
+// stores and compares integers and the text is built once per label.
+typedef uint32_t key_label_id;
+
+#define KEY_LABEL_NONE 0
+
+struct key_label {
+    std::string text;       // "Ctrl + Shift + A", "Enter", "Left Click", ...
+    uint32_t kind;          // input_event_kind
+    uint32_t modifiers;     // input_event_modifier bits
+    uint32_t key_offset;    // Start of the key name in text, after the modifier prefix
+    char typed;             // Character it adds to the typed stream (0 = none)
+    redactor_input input;   // How it feeds the secret redactor
+    bool groupable;         // Single letter or digit (or non-ASCII character) without modifiers
+};
+
+// Label of a queued event under the active keyboard layout; KEY_LABEL_NONE
+// if the key has no name. The first lookup of a combination formats it;
+// later lookups are a hash probe. Thread-safe.
+key_label_id key_label_for_event(const input_event& event);
+
+// "*" standing in for a redacted character; groups like a typed character
+key_label_id key_label_masked();
+
+// Labels are never freed or moved, so the reference stays valid. Thread-safe.
+const key_label& key_label_get(key_label_id id);
@@ -0,0 +1,272 @@
+#include "key-names.h"
+#include <obs-module.h>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#elif defined(__linux__)
+#include <linux/input-event-codes.h>
+#include <xkbcommon/xkbcommon.h>
+#endif
+
+struct special_key {
+    uint16_t code;
+    const char* name;
+};
+
+typedef std::array<const char*, KEY_TABLE_SIZE> special_key_table;
+
+// Dense code -> name table, filled at compile time
+template <size_t N>
+static constexpr special_key_table make_special_table(const special_key (&keys)[N])
+{
+    special_key_table table = {};
+    for (size_t i = 0; i < N; i++) {
+        table[keys[i].code] = keys[i].name;
+    }
+    return table;
+}
+
+// Printable text of every key under one keyboard layout
+struct key_layout {
+    uintptr_t handle;                           // HKL on Windows, xkb layout index on Linux
+    std::string printable[KEY_TABLE_SIZE][2];   // UTF-8 [unshifted, shifted]; "" = not printable
+};
+
+static std::mutex layouts_mutex;
+static std::vector<std::unique_ptr<key_layout>> layouts; // Only grows, so indices stay valid
+
+// Control characters (Tab, Enter, Esc, Backspace) are named by the special tables
+static bool is_printable(uint32_t codepoint)
+{
+    return codepoint >= 0x20 && codepoint != 0x7F && !(codepoint >= 0x80 && codepoint < 0xA0);
+}
+
+static std::string encode_utf8(uint32_t codepoint)
+{
+    std::string out;
+    if (codepoint < 0x80) {
+        out += (char)codepoint;
+    } else if (codepoint < 0x800) {
+        out += (char)(0xC0 | (codepoint >> 6));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else if (codepoint < 0x10000) {
+        out += (char)(0xE0 | (codepoint >> 12));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    } else {
+        out += (char)(0xF0 | (codepoint >> 18));
+        out += (char)(0x80 | ((codepoint >> 12) & 0x3F));
+        out += (char)(0x80 | ((codepoint >> 6) & 0x3F));
+        out += (char)(0x80 | (codepoint & 0x3F));
+    }
+    return out;
+}
+
+#ifdef _WIN32
+static constexpr special_key special_keys[] = {
+    {VK_BACK, "Backspace"},
+    {VK_TAB, "Tab"},
+    {VK_RETURN, "Enter"},
+    {VK_SPACE, "Space"},
+    {VK_ESCAPE, "Esc"},
+    {VK_PRIOR, "PgUp"},
+    {VK_NEXT, "PgDn"},
+    {VK_END, "End"},
+    {VK_HOME, "Home"},
+    {VK_LEFT, "←"},
+    {VK_UP, "↑"},
+    {VK_RIGHT, "→"},
+    {VK_DOWN, "↓"},
+    {VK_INSERT, "Ins"},
+    {VK_DELETE, "Del"},
+    {VK_F1, "F1"}, {VK_F2, "F2"}, {VK_F3, "F3"}, {VK_F4, "F4"},
+    {VK_F5, "F5"}, {VK_F6, "F6"}, {VK_F7, "F7"}, {VK_F8, "F8"},
+    {VK_F9, "F9"}, {VK_F10, "F10"}, {VK_F11, "F11"}, {VK_F12, "F12"},
+    {VK_NUMLOCK, "NumLock"},
+    {VK_SCROLL, "ScrollLock"},
+    {VK_CAPITAL, "CapsLock"},
+};
+
+// Layout of the window receiving input (GetKeyboardLayout(0) would be OBS's own)
+static uintptr_t active_layout_handle()
+{
+    DWORD thread = GetWindowThreadProcessId(GetForegroundWindow(), nullptr);
+    return (uintptr_t)GetKeyboardLayout(thread);
+}
+
+static void build_layout(key_layout* layout)
+{
+    HKL hkl = (HKL)layout->handle;
+    BYTE keyboard_state[256] = {0};
+
+    for (UINT vk = 0; vk < KEY_TABLE_SIZE; vk++) {
+        UINT scan_code = MapVirtualKeyExW(vk, MAPVK_VK_TO_VSC, hkl);
+        if (!scan_code)
+            continue;
+
+        for (int shift = 0; shift < 2; shift++) {
+            keyboard_state[VK_SHIFT] = shift ? 0x80 : 0;
+
+            // Flag 0x4: leave the kernel's dead-key state alone
+            WCHAR chars[8] = {0};
+            int length = ToUnicodeEx(vk, scan_code, keyboard_state, chars, 8, 0x4, hkl);
+            if (length < 0)
+                length = 1; // Dead key: chars holds its spacing form (e.g. '^')
+            if (length == 0 || !is_printable(chars[0]))
+                continue;
+
+            // Letters are displayed uppercase, like the key caps
+            if (!shift) {
+                CharUpperBuffW(chars, (DWORD)length);
+            }
+
+            char utf8[32];
+            int bytes = WideCharToMultiByte(CP_UTF8, 0, chars, length, utf8, sizeof(utf8), nullptr, nullptr);
+            if (bytes > 0) {
+                layout->printable[vk][shift].assign(utf8, (size_t)bytes);
+            }
+        }
+    }
+}
+#elif defined(__linux__)
+// evdev codes are X keycodes minus 8
+#define XKB_EVDEV_OFFSET 8
+
+static constexpr special_key special_keys[] = {
+    {KEY_BACKSPACE, "Backspace"},
+    {KEY_TAB, "Tab"},
+    {KEY_ENTER, "Enter"},
+    {KEY_KPENTER, "Enter"},
+    {KEY_SPACE, "Space"},
+    {KEY_ESC, "Esc"},
+    {KEY_PAGEUP, "PgUp"},
+    {KEY_PAGEDOWN, "PgDn"},
+    {KEY_END, "End"},
+    {KEY_HOME, "Home"},
+    {KEY_LEFT, "←"},
+    {KEY_UP, "↑"},
+    {KEY_RIGHT, "→"},
+    {KEY_DOWN, "↓"},
+    {KEY_INSERT, "Ins"},
+    {KEY_DELETE, "Del"},
+    {KEY_F1, "F1"}, {KEY_F2, "F2"}, {KEY_F3, "F3"}, {KEY_F4, "F4"},
+    {KEY_F5, "F5"}, {KEY_F6, "F6"}, {KEY_F7, "F7"}, {KEY_F8, "F8"},
+    {KEY_F9, "F9"}, {KEY_F10, "F10"}, {KEY_F11, "F11"}, {KEY_F12, "F12"},
+    {KEY_NUMLOCK, "NumLock"},
+    {KEY_SCROLLLOCK, "ScrollLock"},
+    {KEY_CAPSLOCK, "CapsLock"},
+};
+
+static uintptr_t active_layout_handle()
+{
+    return 0;
+}
+
+// Character a key produces at one shift level; keypad keys fall back to the
+// other level (their first level is KP_Home etc. with NumLock off)
+static uint32_t key_codepoint(xkb_keymap* keymap, xkb_keycode_t keycode,
+    xkb_layout_index_t group, xkb_level_index_t level, bool uppercase)
+{
+    xkb_level_index_t levels = xkb_keymap_num_levels_for_key(keymap, keycode, group);
+    for (xkb_level_index_t attempt = 0; attempt < 2 && attempt < levels; attempt++) {
+        const xkb_keysym_t* syms = nullptr;
+        xkb_level_index_t index = attempt == 0 ? level % levels : (level + 1) % levels;
+        if (xkb_keymap_key_get_syms_by_level(keymap, keycode, group, index, &syms) != 1)
+            continue;
+
+        xkb_keysym_t sym = uppercase ? xkb_keysym_to_upper(syms[0]) : syms[0];
+        uint32_t codepoint = xkb_keysym_to_utf32(sym);
+        if (is_printable(codepoint))
+            return codepoint;
+    }
+    return 0;
+}
+
+static void build_layout(key_layout* layout)
+{
+    static xkb_keymap* keymap = nullptr;
+    static bool keymap_failed = false;
+
+    // Called under layouts_mutex; the keymap lives for the process
+    if (!keymap && !keymap_failed) {
+        xkb_context* context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+        if (context) {
+            keymap = xkb_keymap_new_from_names(context, nullptr, XKB_KEYMAP_COMPILE_NO_FLAGS);
+            xkb_context_unref(context);
+        }
+        keymap_failed = !keymap;
+        if (keymap_failed) {
+            blog(LOG_WARNING, "[INPUT] Can't compile an xkb keymap, printable keys won't be named");
+        } else {
+            blog(LOG_INFO, "[INPUT] Keyboard layout '%s'", xkb_keymap_layout_get_name(keymap, 0));
+        }
+    }
+    if (!keymap)
+        return;
+
+    xkb_layout_index_t group = (xkb_layout_index_t)layout->handle;
+    for (uint32_t code = 0; code < KEY_TABLE_SIZE; code++) {
+        xkb_keycode_t keycode = code + XKB_EVDEV_OFFSET;
+        for (int shift = 0; shift < 2; shift++) {
+            uint32_t codepoint = key_codepoint(keymap, keycode, group, (xkb_level_index_t)shift, !shift);
+            if (codepoint) {
+                layout->printable[code][shift] = encode_utf8(codepoint);
+            }
+        }
+    }
+}
+#else
+static constexpr special_key special_keys[] = {
+    {0, nullptr},
+};
+
+static uintptr_t active_layout_handle()
+{
+    return 0;
+}
+
+static void build_layout(key_layout* layout)
+{
+    UNUSED_PARAMETER(layout);
+}
+#endif
+
+static constexpr special_key_table special_names = make_special_table(special_keys);
+
+uint32_t key_layout_current()
+{
+    uintptr_t handle = active_layout_handle();
+
+    std::lock_guard<std::mutex> lock(layouts_mutex);
+
+    for (size_t i = 0; i < layouts.size(); i++) {
+        if (layouts[i]->handle == handle)
+            return (uint32_t)i;
+    }
+
+    auto layout = std::make_unique<key_layout>();
+    layout->handle = handle;
+    build_layout(layout.get());
+    layouts.push_back(std::move(layout));
+
+    blog(LOG_INFO, "[INPUT] Built key table for keyboard layout %p (%zu layouts)",
+         (void*)handle, layouts.size());
+    return (uint32_t)(layouts.size() - 1);
+}
+
+std::string key_name(uint32_t layout, uint32_t code, bool shift)
+{
+    if (code >= KEY_TABLE_SIZE)
+        return std::string();
+    if (special_names[code])
+        return special_names[code];
+
+    std::lock_guard<std::mutex> lock(layouts_mutex);
+    if (layout >= layouts.size())
+        return std::string();
+    return layouts[layout]->printable[code][shift ? 1 : 0];
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Key codes with a name: virtual keys on Windows, evdev KEY_* below 256 on Linux
+#define KEY_TABLE_SIZE 256
+
+// Index of the translation table for the keyboard layout that is active now.
+// A layout's table (UTF-8 text of every printable key, unshifted and shifted)
+// is built the first time the layout is seen and kept for the process, so
+// switching back and forth costs nothing after the first time. Windows
+// follows the foreground thread's HKL; Linux uses the xkbcommon keymap named
+// by the XKB_DEFAULT_* environment (the system default if unset).
+uint32_t key_layout_current();
+
+// Display name of a key under a layout: special keys ("Enter", "F5", "←")
+// come from fixed tables, printable keys from the layout's table with letters
+// shown uppercase. "" if the key has no name. Thread-safe.
+std::string key_name(uint32_t layout, uint32_t code, bool shift);
@@ -0,0 +1,88 @@
+#include "key-state.h"
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+static inline uint32_t lowest_bit(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (uint32_t)index;
+#else
+    return (uint32_t)__builtin_ctzll(mask);
+#endif
+}
+
+void key_state_init(key_state* state, const key_state_modifier* modifiers, size_t count)
+{
+    memset(state, 0, sizeof(*state));
+
+    if (count > 4)
+        count = 4;
+
+    for (size_t m = 0; m < count; m++) {
+        state->modifier_flags[m] = modifiers[m].flag;
+        for (size_t i = 0; i < modifiers[m].count; i++) {
+            uint32_t code = modifiers[m].codes[i];
+            if (code < KEY_STATE_CODES)
+                state->modifier_masks[m][code / 64] |= 1ull << (code % 64);
+        }
+    }
+    state->modifier_count = count;
+}
+
+void key_state_clear(key_state* state)
+{
+    memset(state->down, 0, sizeof(state->down));
+}
+
+bool key_state_press(key_state* state, uint32_t code, uint64_t timestamp)
+{
+    if (code >= KEY_STATE_CODES)
+        return true;
+
+    uint64_t bit = 1ull << (code % 64);
+    bool was_down = (state->down[code / 64] & bit) != 0;
+    state->down[code / 64] |= bit;
+    state->last_seen[code] = timestamp;
+    if (was_down)
+        state->repeats++;
+    return !was_down;
+}
+
+void key_state_release(key_state* state, uint32_t code)
+{
+    if (code < KEY_STATE_CODES)
+        state->down[code / 64] &= ~(1ull << (code % 64));
+}
+
+size_t key_state_recover(key_state* state, uint64_t now, uint64_t max_age,
+    key_state_query_fn query, void* data)
+{
+    size_t released = 0;
+
+    // Only held keys are visited; usually there are none or one or two
+    for (size_t w = 0; w < KEY_STATE_WORDS; w++) {
+        uint64_t bits = state->down[w];
+        while (bits) {
+            uint32_t code = (uint32_t)(w * 64) + lowest_bit(bits);
+            bits &= bits - 1;
+
+            if (now - state->last_seen[code] < max_age)
+                continue;
+
+            if (query(data, code)) {
+                state->last_seen[code] = now;
+            } else {
+                key_state_release(state, code);
+                released++;
+            }
+        }
+    }
+
+    state->recovered += released;
+    return released;
+}
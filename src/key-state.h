@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Key codes the tracker follows (virtual keys on Windows, evdev KEY_* below
+// 256 on Linux). Higher codes are never reported as held.
+#define KEY_STATE_CODES 256
+#define KEY_STATE_WORDS (KEY_STATE_CODES / 64)
+
+// Keys that set one INPUT_MOD_* flag (e.g. left + right Ctrl)
+struct key_state_modifier {
+    uint32_t flag;
+    const uint32_t* codes;
+    size_t count;
+};
+
+// Which keys are held, kept from the hook's own down/up events instead of
+// asking the OS per event. Modifier flags are derived from the bitset. Owned
+// by the thread delivering key events; not thread-safe.
+struct key_state {
+    uint64_t down[KEY_STATE_WORDS];
+    uint64_t last_seen[KEY_STATE_CODES];    // Timestamp of the last down/repeat per held key
+
+    uint32_t modifier_flags[4];
+    uint64_t modifier_masks[4][KEY_STATE_WORDS];
+    size_t modifier_count;
+
+    // Diagnostics
+    uint64_t recovered;                     // Held keys found released (lost key-ups)
+    uint64_t repeats;                       // Presses of a key already down (autorepeat)
+};
+
+// Up to four modifiers; keys outside KEY_STATE_CODES are ignored
+void key_state_init(key_state* state, const key_state_modifier* modifiers, size_t count);
+
+// Forget every held key (e.g. the event stream had a gap)
+void key_state_clear(key_state* state);
+
+// Returns false if the key was already down (autorepeat)
+bool key_state_press(key_state* state, uint32_t code, uint64_t timestamp);
+
+void key_state_release(key_state* state, uint32_t code);
+
+static inline bool key_state_is_down(const key_state* state, uint32_t code)
+{
+    return code < KEY_STATE_CODES && (state->down[code / 64] >> (code % 64)) & 1;
+}
+
+// INPUT_MOD_* flags of the held modifiers
+static inline uint32_t key_state_modifiers(const key_state* state)
+{
+    uint32_t flags = 0;
+    for (size_t m = 0; m < state->modifier_count; m++) {
+        uint64_t held = 0;
+        for (size_t w = 0; w < KEY_STATE_WORDS; w++) {
+            held |= state->down[w] & state->modifier_masks[m][w];
+        }
+        if (held)
+            flags |= state->modifier_flags[m];
+    }
+    return flags;
+}
+
+// Asks the OS whether a key is physically down
+typedef bool (*key_state_query_fn)(void* data, uint32_t code);
+
+// Stuck key recovery: a key held without a down/repeat event for max_age is
+// checked with query and released if it's actually up (its key-up was lost,
+// e.g. to a hook timeout or a secure desktop switch). Keys still down are
+// refreshed, so each held key is queried at most once per max_age. Returns
+// how many keys were released.
+size_t key_state_recover(key_state* state, uint64_t now, uint64_t max_age,
+    key_state_query_fn query, void* data);
@@ -0,0 +1,166 @@
+#include "keystroke-coalescer.h"
+#include <cstdio>
+
+// Modifiers that make a stroke a shortcut; Shift alone just types
+static const uint32_t chord_modifiers = INPUT_MOD_CTRL | INPUT_MOD_ALT | INPUT_MOD_WIN;
+
+static bool within(uint64_t elapsed, uint64_t window)
+{
+    return window > 0 && elapsed <= window;
+}
+
+void keystroke_coalescer_init(keystroke_coalescer* coalescer, const coalesce_rules& rules)
+{
+    coalescer->rules = rules;
+    coalescer->last_stroke = 0;
+    coalescer->has_last = false;
+}
+
+void keystroke_coalescer_set_rules(keystroke_coalescer* coalescer, const coalesce_rules& rules)
+{
+    coalescer->rules = rules;
+}
+
+// Wheel notches keep one entry while the wheel keeps turning; a direction
+// change shows the new direction and restarts the count
+static bool try_scroll(coalesced_keys* newest, key_label_id label, const key_label& stroke)
+{
+    if (newest->state != COALESCE_SINGLE && newest->state != COALESCE_SCROLL)
+        return false;
+
+    const key_label& last = key_label_get(newest->label);
+    if (last.kind != INPUT_EVENT_MOUSE_WHEEL || last.modifiers != stroke.modifiers)
+        return false;
+
+    if (newest->label == label) {
+        newest->repeat++;
+    } else {
+        newest->label = label;
+        newest->repeat = 1;
+    }
+    newest->state = COALESCE_SCROLL;
+    return true;
+}
+
+static bool try_chord(coalesced_keys* newest, key_label_id label, const key_label& stroke)
+{
+    if (stroke.kind != INPUT_EVENT_KEY || !(stroke.modifiers & chord_modifiers))
+        return false;
+
+    bool open = newest->state == COALESCE_CHORD && newest->chord_count < COALESCE_CHORD_MAX;
+    bool can_open = newest->state == COALESCE_SINGLE && newest->repeat == 1;
+    if (!open && !can_open)
+        return false;
+
+    const key_label& first = key_label_get(newest->label);
+    if (first.kind != INPUT_EVENT_KEY || first.modifiers != stroke.modifiers)
+        return false;
+
+    newest->chord[newest->chord_count++] = label;
+    newest->state = COALESCE_CHORD;
+    return true;
+}
+
+static coalesce_result try_word(coalesced_keys* newest, key_label_id label, const key_label& stroke)
+{
+    if (newest->state == COALESCE_WORD) {
+        if (stroke.groupable) {
+            if (!newest->typed.fits(stroke.text.size()))
+                return COALESCE_NEW;
+            newest->typed.append(stroke.text.data(), stroke.text.size());
+            return COALESCE_GROUPED;
+        }
+
+        // Any other key ends the word and stays with it
+        newest->label = label;
+        newest->repeat = 1;
+        newest->state = COALESCE_WORD_CLOSED;
+        return COALESCE_CLOSED;
+    }
+
+    // A lone letter or digit opens a word when another one follows
+    if (newest->state == COALESCE_SINGLE && newest->repeat == 1 && stroke.groupable) {
+        const key_label& last = key_label_get(newest->label);
+        if (last.groupable) {
+            newest->typed.assign(last.text.data(), last.text.size());
+            newest->typed.append(stroke.text.data(), stroke.text.size());
+            newest->label = KEY_LABEL_NONE;
+            newest->repeat = 0;
+            newest->state = COALESCE_WORD;
+            return COALESCE_GROUPED;
+        }
+    }
+
+    return COALESCE_NEW;
+}
+
+coalesce_result keystroke_coalescer_add(keystroke_coalescer* coalescer, coalesced_keys* newest,
+    key_label_id label, uint64_t timestamp)
+{
+    // Strokes from different devices can arrive slightly out of order
+    uint64_t elapsed = coalescer->has_last && timestamp > coalescer->last_stroke ?
+        timestamp - coalescer->last_stroke : 0;
+    bool first = !coalescer->has_last;
+
+    coalescer->last_stroke = timestamp;
+    coalescer->has_last = true;
+
+    if (!newest || first)
+        return COALESCE_NEW;
+
+    const coalesce_rules& rules = coalescer->rules;
+    const key_label& stroke = key_label_get(label);
+
+    if (stroke.kind == INPUT_EVENT_MOUSE_WHEEL && within(elapsed, rules.scroll_window) &&
+        try_scroll(newest, label, stroke)) {
+        return COALESCE_SCROLLED;
+    }
+
+    if (within(elapsed, rules.repeat_window) && newest->label == label &&
+        (newest->state == COALESCE_SINGLE || newest->state == COALESCE_SCROLL)) {
+        newest->repeat++;
+        return COALESCE_REPEATED;
+    }
+
+    if (within(elapsed, rules.chord_window) && try_chord(newest, label, stroke))
+        return COALESCE_CHORDED;
+
+    if (within(elapsed, rules.word_window))
+        return try_word(newest, label, stroke);
+
+    return COALESCE_NEW;
+}
+
+void coalesced_keys_init(coalesced_keys* keys, key_label_id label)
+{
+    keys->state = COALESCE_SINGLE;
+    keys->label = label;
+    keys->repeat = 1;
+    keys->typed.clear();
+    keys->chord_count = 0;
+}
+
+void coalesced_keys_format(const coalesced_keys* keys, coalesced_text* text)
+{
+    text->assign(keys->typed.c_str(), keys->typed.size());
+    if (keys->label == KEY_LABEL_NONE)
+        return;
+
+    if (!text->empty()) {
+        text->append(" + ");
+    }
+    const key_label& label = key_label_get(keys->label);
+    text->append(label.text.data(), label.text.size());
+    if (keys->repeat > 1) {
+        char count[16];
+        snprintf(count, sizeof(count), " x%u", keys->repeat);
+        text->append(count);
+    }
+
+    // Follow-up chord keys drop the shared modifier prefix
+    for (uint32_t i = 0; i < keys->chord_count; i++) {
+        const key_label& key = key_label_get(keys->chord[i]);
+        text->append(", ");
+        text->append(key.text.data() + key.key_offset, key.text.size() - key.key_offset);
+    }
+}
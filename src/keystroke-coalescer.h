@@ -0,0 +1,83 @@
+#pragma once
+
+#include "key-labels.h"
+#include "inline-text.h"
+#include <cstdint>
+
+// Follow-up keys one shortcut chord can hold ("Ctrl + K, S, T, ...")
+#define COALESCE_CHORD_MAX 4
+
+// Bytes of typed word one entry holds; a longer word continues in a new entry
+#define COALESCE_TYPED_MAX 64
+
+// Room for the longest formatted entry: a full word, the longest label with
+// every modifier, a repeat count and a full chord
+#define COALESCE_TEXT_MAX 192
+
+typedef inline_text<COALESCE_TYPED_MAX> coalesced_typed;
+typedef inline_text<COALESCE_TEXT_MAX> coalesced_text;
+
+// Which rule an entry is open for. Stored with the entry, so expiry, eviction
+// and redaction never leave the engine with stale state of its own.
+enum coalesce_state : uint32_t {
+    COALESCE_SINGLE,        // One label, possibly repeated ("A x3")
+    COALESCE_WORD,          // Typed word still open ("HELLO")
+    COALESCE_WORD_CLOSED,   // Word ended by a key ("HELLO + Enter")
+    COALESCE_CHORD,         // Keys under the same modifiers ("Ctrl + K, S")
+    COALESCE_SCROLL,        // Wheel notches ("Scroll Down x12")
+};
+
+// Structured content of one history entry; display text is formatted from it
+struct coalesced_keys {
+    coalesce_state state;
+    key_label_id label;                         // Single / closing / scroll / chord's first key
+    uint32_t repeat;                            // Times label was pressed in a row
+    coalesced_typed typed;                      // Word letters before label
+    key_label_id chord[COALESCE_CHORD_MAX];     // Keys after label, same modifiers
+    uint32_t chord_count;
+};
+
+// Each window is the longest gap (ns) between two strokes the rule merges;
+// 0 turns the rule off. Wheel notches try the scroll rule first; everything
+// else tries repeats, then chords, then words, so a key pressed twice counts
+// rather than chords.
+struct coalesce_rules {
+    uint64_t repeat_window;     // Same label again: "A x2"
+    uint64_t word_window;       // Plain letters/digits: "HELLO", closed by a key: "HELLO + Enter"
+    uint64_t chord_window;      // Same Ctrl/Alt/Win modifiers: "Ctrl + K, S"
+    uint64_t scroll_window;     // Wheel notches in either direction: "Scroll Up x12"
+};
+
+enum coalesce_result {
+    COALESCE_NEW,               // Caller appends a new entry (see coalesced_keys_init)
+    COALESCE_REPEATED,
+    COALESCE_GROUPED,
+    COALESCE_CLOSED,
+    COALESCE_CHORDED,
+    COALESCE_SCROLLED,
+};
+
+// State machine deciding how each stroke joins the history. It never reads
+// a clock: callers pass the stroke's timestamp, which keeps it deterministic.
+// Every decision looks at the newest entry only and edits it in place.
+struct keystroke_coalescer {
+    coalesce_rules rules;
+    uint64_t last_stroke;   // Timestamp of the previous stroke
+    bool has_last;
+};
+
+void keystroke_coalescer_init(keystroke_coalescer* coalescer, const coalesce_rules& rules);
+
+// Takes effect from the next stroke
+void keystroke_coalescer_set_rules(keystroke_coalescer* coalescer, const coalesce_rules& rules);
+
+// Merge a stroke into newest (nullptr if the history is empty). Returns
+// COALESCE_NEW without touching newest when it starts a new entry.
+coalesce_result keystroke_coalescer_add(keystroke_coalescer* coalescer, coalesced_keys* newest,
+    key_label_id label, uint64_t timestamp);
+
+// Entry holding a single stroke
+void coalesced_keys_init(coalesced_keys* keys, key_label_id label);
+
+// "HELLO + Enter", "A x3", "Ctrl + K, S"
+void coalesced_keys_format(const coalesced_keys* keys, coalesced_text* text);
@@ -0,0 +1,42 @@
+#include "keystroke-history.h"
+
+void keystroke_history_init(keystroke_history* history, uint32_t capacity)
+{
+    history->head = 0;
+    history->count = 0;
+    history->capacity = 1;
+    keystroke_history_set_capacity(history, capacity);
+}
+
+void keystroke_history_set_capacity(keystroke_history* history, uint32_t capacity)
+{
+    if (capacity < 1)
+        capacity = 1;
+    if (capacity > KEYSTROKE_HISTORY_MAX)
+        capacity = KEYSTROKE_HISTORY_MAX;
+
+    while (history->count > capacity) {
+        keystroke_history_pop_oldest(history);
+    }
+    history->capacity = capacity;
+}
+
+keystroke_entry* keystroke_history_push(keystroke_history* history)
+{
+    if (history->count == history->capacity) {
+        keystroke_history_pop_oldest(history);
+    }
+    history->count++;
+    return keystroke_history_at(history, history->count - 1);
+}
+
+void keystroke_history_pop_oldest(keystroke_history* history)
+{
+    if (!history->count)
+        return;
+
+    // Release the layout now rather than whenever the slot is reused
+    history->slots[history->head].layout.reset();
+    history->head = (history->head + 1) % KEYSTROKE_HISTORY_MAX;
+    history->count--;
+}
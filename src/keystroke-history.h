@@ -0,0 +1,65 @@
+#pragma once
+
+#include "keystroke-coalescer.h"
+#include "text-layout.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
+// Most entries a source can show (upper bound of the max_entries setting)
+#define KEYSTROKE_HISTORY_MAX 20
+
+struct keystroke_entry {
+    uint64_t id; // Stable across text edits; lets the renderer follow a line as it moves
+    coalesced_keys keys; // Strokes merged into this entry (see keystroke-coalescer.h)
+    coalesced_text text; // Display text, formatted from keys whenever they change
+    std::shared_ptr<const text_layout> layout; // Measured text, rebuilt whenever text or font changes
+    std::chrono::steady_clock::time_point created; // Start of the fade-in
+    std::chrono::steady_clock::time_point timestamp; // Last edit; the fade-out counts from here
+    float alpha; // Opacity, animated every tick without rebuilding the layout
+};
+
+// Entries in edit order (oldest first) in a fixed ring of slots, so adding,
+// evicting and expiring never move or allocate entries. Which end is drawn on
+// top is up to the reader (keystroke_history_row), not the storage order.
+struct keystroke_history {
+    keystroke_entry slots[KEYSTROKE_HISTORY_MAX];
+    uint32_t head;      // Slot of the oldest entry
+    uint32_t count;
+    uint32_t capacity;  // Entries kept (max_entries), at most KEYSTROKE_HISTORY_MAX
+};
+
+void keystroke_history_init(keystroke_history* history, uint32_t capacity);
+
+// Shrinking drops the oldest entries
+void keystroke_history_set_capacity(keystroke_history* history, uint32_t capacity);
+
+// Slot for a new newest entry, evicting the oldest when full. The caller
+// fills in every field.
+keystroke_entry* keystroke_history_push(keystroke_history* history);
+
+void keystroke_history_pop_oldest(keystroke_history* history);
+
+// index 0 = oldest, count - 1 = newest
+static inline keystroke_entry* keystroke_history_at(keystroke_history* history, uint32_t index)
+{
+    return &history->slots[(history->head + index) % KEYSTROKE_HISTORY_MAX];
+}
+
+static inline const keystroke_entry* keystroke_history_at(const keystroke_history* history, uint32_t index)
+{
+    return &history->slots[(history->head + index) % KEYSTROKE_HISTORY_MAX];
+}
+
+// Entry drawn on a row, counting from the top
+static inline const keystroke_entry* keystroke_history_row(const keystroke_history* history,
+    uint32_t row, bool newest_on_top)
+{
+    return keystroke_history_at(history, newest_on_top ? history->count - 1 - row : row);
+}
+
+// nullptr when empty
+static inline keystroke_entry* keystroke_history_newest(keystroke_history* history)
+{
+    return history->count ? keystroke_history_at(history, history->count - 1) : nullptr;
+}
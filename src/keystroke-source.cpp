@@ -4,8 +4,17 @@
 #include <obs-module.h>
 #include <util/platform.h>
 #include <algorithm>
+#include <cctype>
 #include <cmath>
 
+// Entry animation: a short fade-in when added, and a fade-out once
+// fade_duration has passed since the last edit
+#define ENTRY_FADE_IN_SECONDS 0.15f
+#define ENTRY_FADE_OUT_SECONDS 0.4f
+
+// Longest pause between wheel notches that still adds to the same entry
+#define SCROLL_ACCUMULATE_SECONDS 0.5f
+
 // Forward declarations
 static const char* keystroke_source_get_name(void* unused);
 static void* keystroke_source_create(obs_data_t* settings, obs_source_t* source);
@@ -18,6 +27,18 @@ static void keystroke_source_get_defaults(obs_data_t* settings);
 static obs_properties_t* keystroke_source_get_properties(void* data);
 static void keystroke_source_tick(void* data, float seconds);
 
+static uint64_t seconds_to_ns(float seconds)
+{
+    return seconds > 0 ? (uint64_t)(seconds * 1e9) : 0;
+}
+
+// Monitored capture source changed - cached filter decisions are stale
+static void capture_target_changed(void* data)
+{
+    keystroke_source* context = static_cast<keystroke_source*>(data);
+    filter_cache_invalidate(&context->window_filter);
+}
+
 void keystroke_source_register()
 {
     struct obs_source_info keystroke_source_info = {};
@@ -48,14 +69,27 @@ static void* keystroke_source_create(obs_data_t* settings, obs_source_t* source)
 {
     keystroke_source* context = new keystroke_source();
     context->source = source;
-    context->texture = nullptr;
+    context->renderer = text_renderer_create();
     context->cx = 400;
     context->cy = 200;
     context->is_capturing = false;
-    context->in_password_field = false;
     context->last_update = std::chrono::steady_clock::now();
-    context->last_keystroke_time = std::chrono::steady_clock::now();
-    context->current_group = "";
+    keystroke_coalescer_init(&context->coalescer, coalesce_rules());
+    context->history_generation = 1;
+    context->alpha_generation = 1;
+    context->next_deadline = 0;
+    context->next_entry_id = 1;
+    keystroke_history_init(&context->history, KEYSTROKE_HISTORY_MAX);
+    context->display_newest_on_top = false;
+    context->reported_input_drops = 0;
+    input_queue_init(&context->input_events);
+    filter_cache_init(&context->window_filter);
+    context->window_provider = default_window_info_provider();
+    source_target_init(&context->capture_target, capture_target_changed, context);
+    process_cache_init(&context->process_names);
+    privacy_guard_init(&context->privacy);
+    secret_redactor_init(&context->redactor);
+    context->process_provider = default_process_info_provider();
     
     // Update settings first before starting capture
     keystroke_source_update(context, settings);
@@ -73,12 +107,10 @@ static void keystroke_source_destroy(void* data)
     keystroke_source* context = static_cast<keystroke_source*>(data);
     
     stop_input_capture(context);
+    source_target_free(&context->capture_target);
+    process_cache_clear(&context->process_names, &context->process_provider);
     
-    if (context->texture) {
-        obs_enter_graphics();
-        gs_texture_destroy(context->texture);
-        obs_leave_graphics();
-    }
+    text_renderer_destroy(context->renderer);
     
     delete context;
     blog(LOG_INFO, "Keystroke History source destroyed");
@@ -89,8 +121,6 @@ static void keystroke_source_update(void* data, obs_data_t* settings)
     keystroke_source* context = static_cast<keystroke_source*>(data);
     
     context->max_entries = (int)obs_data_get_int(settings, "max_entries");
-    context->show_mouse_clicks = obs_data_get_bool(settings, "show_mouse_clicks");
-    context->ignore_modifier_keys_alone = obs_data_get_bool(settings, "ignore_modifier_keys");
     context->fade_duration = (float)obs_data_get_double(settings, "fade_duration");
     
     context->font_name = obs_data_get_string(settings, "font_name");
@@ -100,17 +130,45 @@ static void keystroke_source_update(void* data, obs_data_t* settings)
     context->background_color = (uint32_t)obs_data_get_int(settings, "background_color");
     context->show_background = obs_data_get_bool(settings, "show_background");
     context->background_opacity = (float)obs_data_get_double(settings, "background_opacity");
-    context->capture_area_only = obs_data_get_bool(settings, "capture_area_only");
-    context->target_window = obs_data_get_string(settings, "target_window");
-    context->capture_source_name = obs_data_get_string(settings, "capture_source_name");
-    context->use_source_capture = obs_data_get_bool(settings, "use_source_capture");
+    
+    auto capture = std::make_shared<capture_settings>();
+    capture->show_mouse_clicks = obs_data_get_bool(settings, "show_mouse_clicks");
+    capture->ignore_modifier_keys_alone = obs_data_get_bool(settings, "ignore_modifier_keys");
+    capture->capture_area_only = obs_data_get_bool(settings, "capture_area_only");
+    capture->target_window = obs_data_get_string(settings, "target_window");
+    capture->capture_source_name = obs_data_get_string(settings, "capture_source_name");
+    capture->use_source_capture = obs_data_get_bool(settings, "use_source_capture");
+    
+    // Compile the window patterns once here instead of per keystroke
+    window_matcher_compile(&capture->target_matcher, capture->target_window);
+    
+    // Only track the capture source while source filtering is active
+    source_target_set_name(&context->capture_target,
+        capture->capture_area_only && capture->use_source_capture ?
+            capture->capture_source_name : std::string());
+    
+    std::atomic_store(&context->capture, std::shared_ptr<const capture_settings>(capture));
+    
+    // Any cached filter decision may be stale now, and the source may now
+    // share its filter with a different set of sources
+    filter_cache_invalidate(&context->window_filter);
+    input_capture_filter_changed(context);
+    
+    // Privacy rules are compiled once; the hook only reads the resulting flag
+    privacy_guard_set_rules(&context->privacy,
+        obs_data_get_string(settings, "privacy_keywords"),
+        obs_data_get_string(settings, "privacy_classes"));
+    
+    secret_redactor_configure(&context->redactor,
+        (uint32_t)obs_data_get_int(settings, "redact_digit_run"),
+        obs_data_get_string(settings, "redact_prompts"));
     
     // Log filter configuration for debugging
-    if (context->capture_area_only) {
-        if (context->use_source_capture && !context->capture_source_name.empty()) {
-            blog(LOG_INFO, "[CONFIG] Source filtering ENABLED - Target source: '%s'", context->capture_source_name.c_str());
-        } else if (!context->target_window.empty()) {
-            blog(LOG_INFO, "[CONFIG] Window filtering ENABLED - Target: '%s'", context->target_window.c_str());
+    if (capture->capture_area_only) {
+        if (capture->use_source_capture && !capture->capture_source_name.empty()) {
+            blog(LOG_INFO, "[CONFIG] Source filtering ENABLED - Target source: '%s'", capture->capture_source_name.c_str());
+        } else if (!capture->target_window.empty()) {
+            blog(LOG_INFO, "[CONFIG] Window filtering ENABLED - Target: '%s'", capture->target_window.c_str());
         } else {
             blog(LOG_INFO, "[CONFIG] Filtering ENABLED - Capturing from ALL windows");
         }
@@ -120,14 +178,113 @@ static void keystroke_source_update(void* data, obs_data_t* settings)
     
     context->group_keystrokes = obs_data_get_bool(settings, "group_keystrokes");
     context->group_duration = (float)obs_data_get_double(settings, "group_duration");
-    context->display_newest_on_top = obs_data_get_bool(settings, "display_newest_on_top");
+    context->repeat_duration = (float)obs_data_get_double(settings, "repeat_duration");
+    context->group_chords = obs_data_get_bool(settings, "group_chords");
+    context->accumulate_scroll = obs_data_get_bool(settings, "accumulate_scroll");
+    bool newest_on_top = obs_data_get_bool(settings, "display_newest_on_top");
+    
+    // Chords are typed at shortcut pace, so they share the repeat window
+    coalesce_rules rules;
+    rules.repeat_window = seconds_to_ns(context->repeat_duration);
+    rules.word_window = context->group_keystrokes ? seconds_to_ns(context->group_duration) : 0;
+    rules.chord_window = context->group_chords ? seconds_to_ns(context->repeat_duration) : 0;
+    rules.scroll_window = context->accumulate_scroll ? seconds_to_ns(SCROLL_ACCUMULATE_SECONDS) : 0;
+    
+    // Loading a face can hit the disk - do it before taking the lock
+    std::shared_ptr<font_face> font = font_cache_acquire(context->font_name, context->font_size);
     
-    // Limit entries to max
     std::lock_guard<std::mutex> lock(context->entries_mutex);
-    if (context->entries.size() > (size_t)context->max_entries) {
-        context->entries.erase(context->entries.begin(), 
-            context->entries.begin() + (context->entries.size() - context->max_entries));
+    
+    keystroke_coalescer_set_rules(&context->coalescer, rules);
+    
+    // Direction is only a view over the history
+    context->display_newest_on_top = newest_on_top;
+    
+    // Limit entries to max, dropping the oldest
+    keystroke_history_set_capacity(&context->history, (uint32_t)context->max_entries);
+    
+    // Existing entries were measured with the old face
+    if (font != context->font) {
+        context->font = font;
+        for (uint32_t i = 0; i < context->history.count; i++) {
+            keystroke_entry* entry = keystroke_history_at(&context->history, i);
+            entry->layout = text_layout_create(font, entry->text.c_str(), entry->text.size());
+        }
+    }
+    
+    // Fonts, colors, layout and fade timing may have changed
+    context->history_generation++;
+    context->next_deadline.store(0, std::memory_order_release);
+}
+
+// Opacity of an entry at `now`: fade-in from creation, fade-out once
+// fade_duration has passed since its last edit
+static float entry_alpha(const keystroke_entry& entry, std::chrono::steady_clock::time_point now,
+    float fade_duration)
+{
+    float age = std::chrono::duration<float>(now - entry.created).count();
+    float alpha = std::min(age / ENTRY_FADE_IN_SECONDS, 1.0f);
+    
+    if (fade_duration > 0) {
+        float idle = std::chrono::duration<float>(now - entry.timestamp).count();
+        if (idle > fade_duration) {
+            alpha = std::min(alpha, 1.0f - (idle - fade_duration) / ENTRY_FADE_OUT_SECONDS);
+        }
+    }
+    return std::max(alpha, 0.0f);
+}
+
+// Expire and animate entries; returns when this next needs to run
+// (entries_mutex held). Entries are in edit order, so expiry only ever
+// happens at the old end.
+static std::chrono::steady_clock::time_point advance_entries(keystroke_source* context,
+    std::chrono::steady_clock::time_point now)
+{
+    using clock = std::chrono::steady_clock;
+    keystroke_history* history = &context->history;
+    const float fade_duration = context->fade_duration;
+    
+    if (fade_duration > 0) {
+        auto lifetime = std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<float>(fade_duration + ENTRY_FADE_OUT_SECONDS));
+        size_t removed = 0;
+        while (history->count > 0) {
+            if (now < keystroke_history_at(history, 0)->timestamp + lifetime)
+                break;
+            keystroke_history_pop_oldest(history);
+            removed++;
+        }
+        
+        if (removed > 0) {
+            blog(LOG_DEBUG, "[TICK] Removed %d faded entries", (int)removed);
+            context->history_generation++;
+        }
+    }
+    
+    // Opacity is a draw parameter, so animating it doesn't bump history_generation
+    auto next = clock::time_point::max();
+    bool alpha_changed = false;
+    for (uint32_t i = 0; i < history->count; i++) {
+        keystroke_entry& entry = *keystroke_history_at(history, i);
+        float alpha = entry_alpha(entry, now, fade_duration);
+        if (alpha != entry.alpha) {
+            entry.alpha = alpha;
+            alpha_changed = true;
+        }
+        
+        // Mid-fade entries need every frame; otherwise wake when the fade-out starts
+        auto fade_out = fade_duration > 0 ? entry.timestamp + std::chrono::duration_cast<clock::duration>(
+            std::chrono::duration<float>(fade_duration)) : clock::time_point::max();
+        if (alpha < 1.0f || now >= fade_out) {
+            next = now;
+        } else if (fade_out < next) {
+            next = fade_out;
+        }
     }
+    
+    if (alpha_changed)
+        context->alpha_generation++;
+    return next;
 }
 
 static void keystroke_source_tick(void* data, float seconds)
@@ -148,75 +305,35 @@ static void keystroke_source_tick(void* data, float seconds)
         }
     }
     
+    // (Re)connect to the monitored capture source if needed
+    source_target_poll(&context->capture_target);
+    
+    // Pull everything the hooks queued since the last frame
+    drain_input_events(context);
+    
     auto now = std::chrono::steady_clock::now();
     context->last_update = now;
     
-    // Update alpha values for fade effect - scope the lock
-    {
+    // Fades and expiry only run when the next one is due; other ticks don't
+    // even take the lock
+    if (now.time_since_epoch().count() >= context->next_deadline.load(std::memory_order_acquire)) {
         std::lock_guard<std::mutex> lock(context->entries_mutex);
-        
-        // Don't render if we have no entries
-        if (context->entries.empty()) {
-            return;
-        }
-        
-        blog(LOG_DEBUG, "[TICK] Updating alpha for %d entries", (int)context->entries.size());
-        
-        // Simple disappear after duration (no fade)
-        size_t num_entries = context->entries.size();
-        for (size_t i = 0; i < num_entries; i++) {
-            auto& entry = context->entries[i];
-            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - entry.timestamp).count() / 1000.0f;
-            
-            // Keep at full opacity until fade_duration expires, then mark for removal
-            if (context->fade_duration > 0 && elapsed > context->fade_duration) {
-                entry.alpha = 0.0f; // Mark for removal (disappear, not fade)
-            } else {
-                entry.alpha = 1.0f; // Fully visible
-            }
-        }
-        
-        blog(LOG_DEBUG, "[TICK] Alpha update complete");
-        
-        // Remove fully faded entries
-        auto initial_size = context->entries.size();
-        context->entries.erase(
-            std::remove_if(context->entries.begin(), context->entries.end(),
-                [](const keystroke_entry& e) { return e.alpha <= 0.01f; }),
-            context->entries.end()
-        );
-        
-        if (context->entries.size() != initial_size) {
-            blog(LOG_DEBUG, "[TICK] Removed %d faded entries", (int)(initial_size - context->entries.size()));
-        }
-    } // Lock released here!
-    
-    // Now render WITHOUT holding the lock
-    // render_text_to_texture will acquire its own lock
-    if (!context->entries.empty()) {
-        blog(LOG_DEBUG, "[TICK] About to render %d entries", (int)context->entries.size());
-        render_text_to_texture(context);
-    } else {
-        blog(LOG_DEBUG, "[TICK] No entries to render (after fade removal)");
+        auto next = advance_entries(context, now);
+        context->next_deadline.store(next.time_since_epoch().count(), std::memory_order_release);
     }
+    
+    // Now hand the history to the layout worker WITHOUT holding the lock
+    // text_renderer_update will acquire its own lock and upload the newest finished frame
+    text_renderer_update(context);
 }
 
 static void keystroke_source_render(void* data, gs_effect_t* effect)
 {
     keystroke_source* context = static_cast<keystroke_source*>(data);
     
-    if (!context->texture)
-        return;
-    
-    effect = obs_get_base_effect(OBS_EFFECT_DEFAULT);
+    UNUSED_PARAMETER(effect);
     
-    gs_eparam_t* image = gs_effect_get_param_by_name(effect, "image");
-    gs_effect_set_texture(image, context->texture);
-    
-    while (gs_effect_loop(effect, "Draw")) {
-        gs_draw_sprite(context->texture, 0, context->cx, context->cy);
-    }
+    text_renderer_draw(context);
 }
 
 static uint32_t keystroke_source_get_width(void* data)
@@ -251,7 +368,14 @@ static void keystroke_source_get_defaults(obs_data_t* settings)
     obs_data_set_default_bool(settings, "use_source_capture", false);
     obs_data_set_default_bool(settings, "group_keystrokes", false);
     obs_data_set_default_double(settings, "group_duration", 0.5);
+    obs_data_set_default_double(settings, "repeat_duration", 1.0);
+    obs_data_set_default_bool(settings, "group_chords", false);
+    obs_data_set_default_bool(settings, "accumulate_scroll", true);
     obs_data_set_default_bool(settings, "display_newest_on_top", false); // Default: newest at bottom
+    obs_data_set_default_string(settings, "privacy_keywords", "password\nlogin\nsign in");
+    obs_data_set_default_string(settings, "privacy_classes", "");
+    obs_data_set_default_int(settings, "redact_digit_run", 12);
+    obs_data_set_default_string(settings, "redact_prompts", "sudo\npasswd\npassword:\npassword=\ntoken=\nsecret=");
 }
 
 static obs_properties_t* keystroke_source_get_properties(void* data)
@@ -326,6 +450,15 @@ static obs_properties_t* keystroke_source_get_properties(void* data)
     obs_properties_add_float_slider(props, "group_duration",
         obs_module_text("GroupDuration"), 0.1, 2.0, 0.1);
     
+    obs_properties_add_float_slider(props, "repeat_duration",
+        obs_module_text("RepeatDuration"), 0.0, 3.0, 0.1);
+    
+    obs_properties_add_bool(props, "group_chords",
+        obs_module_text("GroupChords"));
+    
+    obs_properties_add_bool(props, "accumulate_scroll",
+        obs_module_text("AccumulateScroll"));
+    
     // Area-based capture settings
     obs_properties_add_bool(props, "capture_area_only",
         obs_module_text("CaptureAreaOnly"));
@@ -363,126 +496,143 @@ static obs_properties_t* keystroke_source_get_properties(void* data)
         return true; // Continue enumeration
     }, source_list);
     
-    // Text field for target window title (partial match, case-insensitive)
+    // Target window patterns (one per line, case-insensitive)
     obs_property_t* target_window = obs_properties_add_text(props, "target_window",
-        obs_module_text("TargetWindow"), OBS_TEXT_DEFAULT);
+        obs_module_text("TargetWindow"), OBS_TEXT_MULTILINE);
     
     obs_property_set_long_description(target_window,
-        "Enter part of the window title to filter (e.g., 'notepad', 'chrome', 'autocad'). "
-        "Leave empty to capture from all windows. Case-insensitive partial match. "
+        "Enter one pattern per line (or separate with ';'). Plain text matches any window "
+        "whose title contains it (e.g., 'notepad', 'code'). '*' is a wildcard ('visual studio*'), "
+        "and a leading '!' excludes matching windows ('!chrome'). "
+        "Leave empty to capture from all windows. Case-insensitive. "
         "Ignored if 'Use OBS Source Capture' is enabled.");
     
+    // Privacy: hide keystrokes while these windows/controls have focus
+    obs_property_t* privacy_keywords = obs_properties_add_text(props, "privacy_keywords",
+        obs_module_text("PrivacyKeywords"), OBS_TEXT_MULTILINE);
+    
+    obs_property_set_long_description(privacy_keywords,
+        "Keystrokes are hidden while the focused window title matches any of these "
+        "patterns (same syntax as the target window list). Password edit boxes are always hidden.");
+    
+    obs_property_t* privacy_classes = obs_properties_add_text(props, "privacy_classes",
+        obs_module_text("PrivacyClasses"), OBS_TEXT_MULTILINE);
+    
+    obs_property_set_long_description(privacy_classes,
+        "Window or control class names (e.g. 'Credential Dialog Xaml Host') that "
+        "should always hide keystrokes.");
+    
+    // Secret redaction on the typed stream
+    obs_properties_add_int_slider(props, "redact_digit_run",
+        obs_module_text("RedactDigitRun"), 0, REDACT_MAX_DIGIT_RUN, 1);
+    
+    obs_property_t* redact_prompts = obs_properties_add_text(props, "redact_prompts",
+        obs_module_text("RedactPrompts"), OBS_TEXT_MULTILINE);
+    
+    obs_property_set_long_description(redact_prompts,
+        "Typing any of these (one per line) masks the rest of the line and the next line, "
+        "e.g. 'token=' or a 'sudo' command followed by its password prompt. "
+        "Each line is matched as plain text, case-insensitively; '*', '!' and ';' have no special meaning.");
+    
     return props;
 }
 
-void add_keystroke(keystroke_source* context, const std::string& keystroke)
+// Entry text is only ever rebuilt through here, from the structured fields,
+// so its layout stays in step (entries_mutex held)
+static void format_entry(keystroke_source* context, keystroke_entry& entry)
+{
+    coalesced_keys_format(&entry.keys, &entry.text);
+    entry.layout = text_layout_create(context->font, entry.text.c_str(), entry.text.size());
+}
+
+void add_keystroke(keystroke_source* context, key_label_id label,
+    std::chrono::steady_clock::time_point when)
 {
-    if (!context || keystroke.empty())
+    if (!context || label == KEY_LABEL_NONE)
         return;
     
     std::lock_guard<std::mutex> lock(context->entries_mutex);
     
-    auto now = std::chrono::steady_clock::now();
-    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now - context->last_keystroke_time).count() / 1000.0f;
-    
-    // Check if we should count repetitions or group keystrokes
-    if (!context->entries.empty() && elapsed < 1.0f) { // Within 1 second window
-        // Always work with the most recent entry (at end if newest_on_bottom, at start if newest_on_top)
-        size_t recent_index = context->display_newest_on_top ? 0 : context->entries.size() - 1;
-        auto& last_entry = context->entries[recent_index];
+    // Every path below either edits the newest entry or adds one
+    context->history_generation++;
+    context->next_deadline.store(0, std::memory_order_release);
+    
+    // The hook timestamp drives the rules, so batched delivery doesn't distort grouping
+    keystroke_entry* newest = keystroke_history_newest(&context->history);
+    
+    coalesce_result result = keystroke_coalescer_add(&context->coalescer,
+        newest ? &newest->keys : nullptr, label,
+        (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(when.time_since_epoch()).count());
+    
+    if (result != COALESCE_NEW) {
+        format_entry(context, *newest);
+        newest->timestamp = when;
         
-        // Check for key repetition (same key pressed multiple times)
-        // Extract base key without count (e.g., "A x3" -> "A")
-        std::string last_key = last_entry.text;
-        size_t x_pos = last_key.find(" x");
-        if (x_pos != std::string::npos) {
-            last_key = last_key.substr(0, x_pos);
-        }
+        static const char* const verbs[] = { "Added", "Repeated", "Grouped", "Completed group with",
+            "Chorded", "Scrolled" };
+        blog(LOG_DEBUG, "[ENTRIES] %s keystroke", verbs[result]);
+        return;
+    }
+    
+    // Add as new entry; the oldest is evicted when the history is full
+    keystroke_entry* entry = keystroke_history_push(&context->history);
+    entry->id = context->next_entry_id++;
+    coalesced_keys_init(&entry->keys, label);
+    format_entry(context, *entry);
+    entry->created = when;
+    entry->timestamp = when;
+    entry->alpha = 0.0f; // Fades in from the next tick
+    
+    // Never log keystroke text: the log outlives any masking applied later
+    blog(LOG_DEBUG, "[ENTRIES] Added keystroke (total entries: %d)", (int)context->history.count);
+}
+
+void mask_recent_digits(keystroke_source* context, uint32_t count)
+{
+    key_label_id masked = key_label_masked();
+    
+    std::lock_guard<std::mutex> lock(context->entries_mutex);
+    
+    // Walk from the most recent entry backwards, masking digits from the end of
+    // each entry. The redactor reports one contiguous run ending at the newest
+    // stroke, so the walk stops at the first key that isn't part of it; digits
+    // already shown as '*' belong to the run but don't count.
+    bool in_run = true;
+    uint32_t num_entries = context->history.count;
+    for (uint32_t k = 0; k < num_entries && in_run && count > 0; k++) {
+        keystroke_entry& entry = *keystroke_history_at(&context->history, num_entries - 1 - k);
+        bool changed = false;
         
-        // If same key pressed again within window, increment count
-        if (last_key == keystroke) {
-            // Extract current count
-            int count = 1;
-            if (x_pos != std::string::npos) {
-                std::string count_str = last_entry.text.substr(x_pos + 2);
-                count = std::stoi(count_str);
+        // A repeated digit ("4 x3") stays readable as "* x3" and accounts for several digits
+        coalesced_keys& keys = entry.keys;
+        if (keys.label != KEY_LABEL_NONE) {
+            if (keys.chord_count > 0 || (keys.label != masked &&
+                !isdigit((unsigned char)key_label_get(keys.label).typed))) {
+                in_run = false;
+            } else if (keys.label != masked) {
+                keys.label = masked;
+                count = count > keys.repeat ? count - keys.repeat : 0;
+                changed = true;
             }
-            count++;
-            
-            // Update entry with count
-            last_entry.text = keystroke + " x" + std::to_string(count);
-            last_entry.timestamp = now;
-            context->last_keystroke_time = now;
-            blog(LOG_INFO, "[ENTRIES] Repeated keystroke: '%s'", last_entry.text.c_str());
-            return;
         }
         
-        // Check if we should group this keystroke (if enabled)
-        if (context->group_keystrokes && elapsed < context->group_duration) {
-            bool is_letter = keystroke.length() == 1 && isalpha(keystroke[0]);
-            bool is_number = keystroke.length() == 1 && isdigit(keystroke[0]);
-            bool is_groupable = is_letter || is_number;
-            
-            // Check if last entry is groupable text (no " x" count, no modifiers)
-            bool last_is_groupable = last_key.find(" + ") == std::string::npos && 
-                                     last_key.find("Click") == std::string::npos &&
-                                     last_key.find("Scroll") == std::string::npos &&
-                                     x_pos == std::string::npos;
-            
-            // If both are groupable, append
-            if (is_groupable && last_is_groupable && !context->current_group.empty()) {
-                context->current_group += keystroke;
-                last_entry.text = context->current_group;
-                last_entry.timestamp = now;
-                context->last_keystroke_time = now;
-                blog(LOG_INFO, "[ENTRIES] Grouped keystroke: '%s'", context->current_group.c_str());
-                return;
-            } else if (is_groupable && last_is_groupable) {
-                // Start grouping with last entry + this one
-                context->current_group = last_key + keystroke;
-                last_entry.text = context->current_group;
-                last_entry.timestamp = now;
-                context->last_keystroke_time = now;
-                blog(LOG_INFO, "[ENTRIES] Started grouping: '%s'", context->current_group.c_str());
-                return;
-            } else if (!is_groupable && !context->current_group.empty()) {
-                // Non-groupable key ends the group
-                last_entry.text = context->current_group + " + " + keystroke;
-                last_entry.timestamp = now;
-                context->last_keystroke_time = now;
-                context->current_group.clear();
-                blog(LOG_INFO, "[ENTRIES] Completed group with special key: '%s'", last_entry.text.c_str());
-                return;
+        for (size_t i = keys.typed.size(); in_run && count > 0 && i-- > 0;) {
+            char c = keys.typed.data[i];
+            if (isdigit((unsigned char)c)) {
+                keys.typed.data[i] = '*';
+                count--;
+                changed = true;
+            } else if (c != '*') {
+                in_run = false;
             }
         }
+        
+        if (changed) {
+            format_entry(context, entry);
+        }
     }
     
-    // Add as new entry
-    context->current_group.clear();
-    
-    keystroke_entry entry;
-    entry.text = keystroke;
-    entry.timestamp = now;
-    entry.alpha = 1.0f;
-    
-    // Add to beginning (newest on top) or end (newest at bottom)
-    if (context->display_newest_on_top) {
-        context->entries.insert(context->entries.begin(), entry);
-    } else {
-        context->entries.push_back(entry);
-    }
-    context->last_keystroke_time = now;
-    
-    blog(LOG_INFO, "[ENTRIES] Added keystroke: '%s' (total entries: %d)", 
-         keystroke.c_str(), (int)context->entries.size());
+    context->history_generation++;
     
-    // Maintain max entries limit
-    if (context->entries.size() > (size_t)context->max_entries) {
-        if (context->display_newest_on_top) {
-            context->entries.pop_back(); // Remove oldest from bottom
-        } else {
-            context->entries.erase(context->entries.begin()); // Remove oldest from top
-        }
-    }
+    blog(LOG_DEBUG, "[ENTRIES] Masked secret digits in recent history");
 }
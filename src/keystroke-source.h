@@ -4,36 +4,61 @@
 #include <graphics/graphics.h>
 #include <vector>
 #include <string>
+#include <atomic>
 #include <chrono>
 #include <mutex>
+#include <memory>
+#include "input-queue.h"
+#include "filter-cache.h"
+#include "source-target.h"
+#include "process-cache.h"
+#include "window-matcher.h"
+#include "privacy-guard.h"
+#include "secret-redactor.h"
+#include "key-labels.h"
+#include "keystroke-history.h"
 
-struct keystroke_entry {
-    std::string text;
-    std::chrono::steady_clock::time_point timestamp;
-    float alpha; // For fade effect
+struct text_renderer;
+
+// Settings read by the capture threads. keystroke_source_update builds a new
+// snapshot and publishes it whole, so a hook never sees a half-applied update
+// or a string being reassigned.
+struct capture_settings {
+    bool show_mouse_clicks;
+    bool ignore_modifier_keys_alone;
+    bool capture_area_only; // Only capture when mouse is in a specific area
+    std::string target_window; // Window title patterns to monitor (empty = any window)
+    window_matcher target_matcher; // Compiled target_window
+    std::string capture_source_name; // OBS source name to monitor (display/window capture)
+    bool use_source_capture; // true = use OBS source, false = use window title
 };
 
 struct keystroke_source {
     obs_source_t* source;
     
-    // Text rendering
-    gs_texture_t* texture;
+    // Text rendering (glyph atlas + quads, see text-renderer.h)
+    text_renderer* renderer;
     uint32_t cx;
     uint32_t cy;
     
     // Settings
     int max_entries;
-    bool show_mouse_clicks;
-    bool ignore_modifier_keys_alone;
     float fade_duration; // seconds
-    bool capture_area_only; // Only capture when mouse is in a specific area
-    std::string target_window; // Window title to monitor (empty = any window)
-    std::string capture_source_name; // OBS source name to monitor (display/window capture)
-    bool use_source_capture; // true = use OBS source, false = use window title
+    std::shared_ptr<const capture_settings> capture; // What the capture threads read (std::atomic_load/store)
     bool group_keystrokes; // Group rapid keystrokes together
     float group_duration; // Maximum time between keystrokes to group (seconds)
+    float repeat_duration; // Maximum time between presses counted as repeats (0 = off)
+    bool group_chords; // Merge shortcuts sharing modifiers ("Ctrl + K, S")
+    bool accumulate_scroll; // Keep wheel notches in one entry
     bool display_newest_on_top; // true = newest at top, false = newest at bottom
     
+    // Window filter: cached decision per foreground window, invalidated on update
+    filter_cache window_filter;
+    window_info_provider window_provider;
+    source_target_resolver capture_target; // Parsed settings of capture_source_name
+    process_cache process_names; // pid -> executable name for game capture matching
+    process_info_provider process_provider;
+    
     // Font settings
     std::string font_name;
     int font_size;
@@ -43,21 +68,30 @@ struct keystroke_source {
     float background_opacity; // 0.0 to 1.0
     std::string text_alignment; // "left", "center", or "right"
     
-    // Keystroke history
-    std::vector<keystroke_entry> entries;
+    // Keystroke history in edit order; display_newest_on_top only changes how it's drawn
+    keystroke_history history;
     std::mutex entries_mutex;
+    std::atomic<uint64_t> history_generation; // Bumped on every layout change (written under entries_mutex)
+    std::atomic<uint64_t> alpha_generation; // Bumped when any entry's alpha changes (same)
+    std::atomic<int64_t> next_deadline; // steady_clock count of the next fade/expiry step, 0 = now
+    std::shared_ptr<font_face> font; // Face the entry layouts use (entries_mutex)
+    uint64_t next_entry_id;
+    
+    // Input events pushed by the hooks, drained at the top of every tick
+    input_queue input_events;
+    uint64_t reported_input_drops;
     
     // Input capture state
     bool is_capturing;
     std::string current_modifiers;
-    bool in_password_field;
+    privacy_guard privacy; // Suppresses capture in password fields / login windows
+    secret_redactor redactor; // Masks secrets in the typed stream (video thread)
     
     // Last update time for fade effect
     std::chrono::steady_clock::time_point last_update;
     
-    // Keystroke grouping
-    std::chrono::steady_clock::time_point last_keystroke_time;
-    std::string current_group; // Accumulator for grouped keystrokes
+    // Keystroke grouping (entries_mutex)
+    keystroke_coalescer coalescer;
 };
 
 // Registration function
@@ -66,4 +100,6 @@ void keystroke_source_register();
 // Input capture functions
 void start_input_capture(keystroke_source* context);
 void stop_input_capture(keystroke_source* context);
-void add_keystroke(keystroke_source* context, const std::string& keystroke);
+void add_keystroke(keystroke_source* context, key_label_id label,
+    std::chrono::steady_clock::time_point when);
+void mask_recent_digits(keystroke_source* context, uint32_t count);
@@ -0,0 +1,72 @@
+#include "line-cache.h"
+
+// Rough per-entry overhead: list node, hash node and the two key copies
+static size_t entry_bytes(const std::string& key, const std::vector<text_vertex>& vertices)
+{
+    return sizeof(line_cache_entry) + 64 + key.size() * 2 +
+           vertices.capacity() * sizeof(text_vertex);
+}
+
+void line_cache_init(line_cache* cache, size_t budget)
+{
+    cache->entries.clear();
+    cache->index.clear();
+    cache->bytes = 0;
+    cache->budget = budget;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+    cache->peak_bytes = 0;
+}
+
+void line_cache_clear(line_cache* cache)
+{
+    cache->entries.clear();
+    cache->index.clear();
+    cache->bytes = 0;
+}
+
+const std::vector<text_vertex>* line_cache_find(line_cache* cache, const std::string& key)
+{
+    auto it = cache->index.find(key);
+    if (it == cache->index.end()) {
+        cache->misses++;
+        return nullptr;
+    }
+
+    // Move to the front (most recently used)
+    cache->entries.splice(cache->entries.begin(), cache->entries, it->second);
+    cache->hits++;
+    return &it->second->vertices;
+}
+
+const std::vector<text_vertex>* line_cache_insert(line_cache* cache, const std::string& key,
+    std::vector<text_vertex>&& vertices)
+{
+    auto existing = cache->index.find(key);
+    if (existing != cache->index.end()) {
+        cache->bytes -= existing->second->bytes;
+        cache->entries.erase(existing->second);
+        cache->index.erase(existing);
+    }
+
+    cache->entries.push_front({ key, std::move(vertices), 0 });
+    line_cache_entry& entry = cache->entries.front();
+    entry.bytes = entry_bytes(entry.key, entry.vertices);
+    cache->index[entry.key] = cache->entries.begin();
+    cache->bytes += entry.bytes;
+
+    // Evict from the back; the new line always stays, even if it alone is over budget
+    while (cache->bytes > cache->budget && cache->entries.size() > 1) {
+        line_cache_entry& victim = cache->entries.back();
+        cache->bytes -= victim.bytes;
+        cache->index.erase(victim.key);
+        cache->entries.pop_back();
+        cache->evictions++;
+    }
+
+    if (cache->bytes > cache->peak_bytes)
+        cache->peak_bytes = cache->bytes;
+
+    return &entry.vertices;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Default memory ceiling for cached lines
+#define LINE_CACHE_BUDGET (256 * 1024)
+
+// One corner of a glyph quad; u/v are atlas texels until upload
+struct text_vertex {
+    float x, y;
+    float u, v;
+};
+
+struct line_cache_entry {
+    std::string key;
+    std::vector<text_vertex> vertices;  // Laid out with the line's top at y = 0
+    size_t bytes;
+};
+
+// Bounded LRU of laid-out history lines, keyed by text plus everything that
+// affects layout (font, size, alignment, box). A new keystroke usually
+// changes one line; every other line is copied from here instead of being
+// laid out again. Entries reference atlas texels, so the cache is cleared
+// whenever the atlas drops its glyphs. Not thread-safe: owned by the video thread.
+struct line_cache {
+    std::list<line_cache_entry> entries;  // Most recently used first
+    std::unordered_map<std::string, std::list<line_cache_entry>::iterator> index;
+    size_t bytes;
+    size_t budget;
+
+    // Diagnostics
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    size_t peak_bytes;
+};
+
+void line_cache_init(line_cache* cache, size_t budget);
+void line_cache_clear(line_cache* cache);
+
+// Cached vertices for key, or nullptr. Valid until the next insert or clear.
+const std::vector<text_vertex>* line_cache_find(line_cache* cache, const std::string& key);
+
+// Store a freshly laid out line, evicting least recently used lines to stay
+// within the budget. Returns the stored vertices.
+const std::vector<text_vertex>* line_cache_insert(line_cache* cache, const std::string& key,
+    std::vector<text_vertex>&& vertices);
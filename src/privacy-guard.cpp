@@ -0,0 +1,80 @@
+#include "privacy-guard.h"
+#include <cstring>
+
+void privacy_guard_init(privacy_guard* guard)
+{
+    guard->suppress.store(false, std::memory_order_relaxed);
+    guard->rules_generation.store(0, std::memory_order_relaxed);
+    std::atomic_store(&guard->rules, std::shared_ptr<const privacy_rules>());
+    guard->has_focus = false;
+    memset(&guard->last_focus, 0, sizeof(guard->last_focus));
+    guard->evaluated_generation = 0;
+    guard->focus_events = 0;
+    guard->evaluations = 0;
+}
+
+void privacy_guard_set_rules(privacy_guard* guard, const std::string& keywords,
+    const std::string& classes)
+{
+    auto rules = std::make_shared<privacy_rules>();
+    window_matcher_compile(&rules->title_keywords, keywords);
+    window_matcher_compile(&rules->classes, classes);
+
+    std::atomic_store(&guard->rules, std::shared_ptr<const privacy_rules>(rules));
+    guard->rules_generation.fetch_add(1, std::memory_order_release);
+}
+
+static bool same_focus(const focus_info* a, const focus_info* b)
+{
+    return a->window_id == b->window_id &&
+           a->focus_id == b->focus_id &&
+           a->password_style == b->password_style &&
+           strcmp(a->title, b->title) == 0 &&
+           strcmp(a->focus_class, b->focus_class) == 0 &&
+           strcmp(a->window_class, b->window_class) == 0;
+}
+
+// An empty pattern list means "no rule", not "match everything"
+static bool rule_matches(const window_matcher* matcher, const char* text)
+{
+    return !window_matcher_empty(matcher) && text[0] && window_matcher_match(matcher, text);
+}
+
+static bool evaluate(const privacy_rules* rules, const focus_info* info)
+{
+    if (info->password_style)
+        return true;
+
+    if (!rules)
+        return false;
+
+    return rule_matches(&rules->title_keywords, info->title) ||
+           rule_matches(&rules->classes, info->window_class) ||
+           rule_matches(&rules->classes, info->focus_class);
+}
+
+void privacy_guard_focus_changed(privacy_guard* guard, const focus_info* info)
+{
+    guard->focus_events++;
+
+    uint32_t generation = guard->rules_generation.load(std::memory_order_acquire);
+    if (guard->has_focus && generation == guard->evaluated_generation &&
+        same_focus(&guard->last_focus, info)) {
+        return;
+    }
+
+    auto rules = std::atomic_load(&guard->rules);
+    bool suppress = evaluate(rules.get(), info);
+
+    guard->last_focus = *info;
+    guard->has_focus = true;
+    guard->evaluated_generation = generation;
+    guard->evaluations++;
+    guard->suppress.store(suppress, std::memory_order_release);
+}
+
+bool privacy_guard_needs_refresh(const privacy_guard* guard)
+{
+    return !guard->has_focus ||
+           guard->rules_generation.load(std::memory_order_acquire) != guard->evaluated_generation;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "window-matcher.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// What the guard knows about the window/control that has keyboard focus
+struct focus_info {
+    uintptr_t window_id;        // Foreground window (0 = none)
+    uintptr_t focus_id;         // Focused control inside it (0 = unknown)
+    char title[256];            // Foreground window title
+    char window_class[128];     // Foreground window class
+    char focus_class[128];      // Focused control class
+    bool password_style;        // Control reports masked input (e.g. ES_PASSWORD)
+};
+
+// Precompiled rule set (see privacy_guard_set_rules)
+struct privacy_rules {
+    window_matcher title_keywords;  // Suppress when the window title matches
+    window_matcher classes;         // Suppress when the window or control class matches
+};
+
+// Decides whether keystrokes must be hidden. Evaluation only happens when the
+// focused window/control changes (or the rules change); the input hook just
+// reads the atomic suppress flag.
+struct privacy_guard {
+    std::atomic<bool> suppress;
+    std::atomic<uint32_t> rules_generation;
+    std::shared_ptr<const privacy_rules> rules; // std::atomic_load/store only
+
+    // Owned by the thread delivering focus changes
+    bool has_focus;
+    focus_info last_focus;
+    uint32_t evaluated_generation;
+
+    // Diagnostics
+    uint64_t focus_events;
+    uint64_t evaluations;
+};
+
+void privacy_guard_init(privacy_guard* guard);
+
+// Compile keyword and class rules (pattern lists in window_matcher syntax).
+// Safe from any thread; takes effect on the next focus change or refresh.
+void privacy_guard_set_rules(privacy_guard* guard, const std::string& keywords,
+    const std::string& classes);
+
+// Feed the current focus state. Cheap when nothing relevant changed.
+void privacy_guard_focus_changed(privacy_guard* guard, const focus_info* info);
+
+// True if rules changed since the last evaluation (caller should feed focus again)
+bool privacy_guard_needs_refresh(const privacy_guard* guard);
+
+static inline bool privacy_guard_suppressed(const privacy_guard* guard)
+{
+    return guard->suppress.load(std::memory_order_acquire);
+}
@@ -0,0 +1,237 @@
+#include "process-cache.h"
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <unistd.h>
+#endif
+
+void process_cache_init(process_cache* cache)
+{
+    memset(cache->entries, 0, sizeof(cache->entries));
+    cache->clock = 0;
+    cache->epoch = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->evictions = 0;
+}
+
+static void release_entry(process_cache_entry* entry, const process_info_provider* provider)
+{
+    if (entry->handle) {
+        provider->close(provider->data, entry->handle);
+        entry->handle = nullptr;
+    }
+}
+
+void process_cache_clear(process_cache* cache, const process_info_provider* provider)
+{
+    for (size_t i = 0; i < PROCESS_CACHE_CAPACITY; i++) {
+        release_entry(&cache->entries[i], provider);
+    }
+    memset(cache->entries, 0, sizeof(cache->entries));
+}
+
+void process_cache_revalidate(process_cache* cache)
+{
+    cache->epoch++;
+}
+
+// "C:\Games\Game.EXE" -> "game.exe"
+static void normalize_exe_name(const char* path, char* out, size_t size)
+{
+    const char* name = path;
+    for (const char* p = path; *p; p++) {
+        if (*p == '\\' || *p == '/') {
+            name = p + 1;
+        }
+    }
+
+    size_t i = 0;
+    for (; name[i] && i + 1 < size; i++) {
+        out[i] = (char)tolower((unsigned char)name[i]);
+    }
+    out[i] = '\0';
+}
+
+const char* process_cache_lookup(process_cache* cache, const process_info_provider* provider,
+    uint32_t pid)
+{
+    cache->clock++;
+
+    process_cache_entry* cached = nullptr;
+    process_cache_entry* victim = &cache->entries[0];
+    for (size_t i = 0; i < PROCESS_CACHE_CAPACITY; i++) {
+        process_cache_entry* entry = &cache->entries[i];
+
+        if (entry->last_used != 0 && entry->pid == pid) {
+            cached = entry;
+            break;
+        }
+
+        if (entry->last_used < victim->last_used) {
+            victim = entry;
+        }
+    }
+
+    // A held handle keeps the pid from being reused, so only entries
+    // without one need a fresh start time
+    if (cached && (cached->handle || cached->checked == cache->epoch)) {
+        cached->last_used = cache->clock;
+        cache->hits++;
+        return cached->exe;
+    }
+
+    uint64_t start_time = 0;
+    void* handle = nullptr;
+    if (!provider->open(provider->data, pid, &start_time, &handle)) {
+        return nullptr;
+    }
+
+    if (cached && cached->start_time == start_time) {
+        cached->handle = handle;
+        cached->checked = cache->epoch;
+        cached->last_used = cache->clock;
+        cache->hits++;
+        return cached->exe;
+    }
+
+    cache->misses++;
+
+    char path[PROCESS_EXE_MAX * 2] = {0};
+    if (!provider->get_image_path(provider->data, pid, handle, path, sizeof(path))) {
+        if (handle) {
+            provider->close(provider->data, handle);
+        }
+        return nullptr;
+    }
+
+    // Same pid, different process - reuse its slot
+    if (cached) {
+        victim = cached;
+    } else if (victim->last_used != 0) {
+        cache->evictions++;
+    }
+    release_entry(victim, provider);
+
+    victim->pid = pid;
+    victim->start_time = start_time;
+    victim->handle = handle;
+    victim->checked = cache->epoch;
+    victim->last_used = cache->clock;
+    normalize_exe_name(path, victim->exe, sizeof(victim->exe));
+    return victim->exe;
+}
+
+#ifdef _WIN32
+// The handle stays open while the entry is cached: Windows doesn't hand out
+// a pid again until every handle to the old process is closed
+static bool win32_open(void* data, uint32_t pid, uint64_t* start_time, void** handle)
+{
+    (void)data;
+
+    HANDLE process = OpenProcess(SYNCHRONIZE | PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+    if (!process)
+        return false;
+
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(process, &creation, &exit, &kernel, &user)) {
+        CloseHandle(process);
+        return false;
+    }
+
+    *start_time = ((uint64_t)creation.dwHighDateTime << 32) | creation.dwLowDateTime;
+    *handle = process;
+    return true;
+}
+
+static void win32_close(void* data, void* handle)
+{
+    (void)data;
+    CloseHandle((HANDLE)handle);
+}
+
+static bool win32_get_image_path(void* data, uint32_t pid, void* handle, char* path, size_t size)
+{
+    (void)data;
+    (void)pid;
+
+    DWORD length = (DWORD)size;
+    return QueryFullProcessImageNameA((HANDLE)handle, 0, path, &length) != 0;
+}
+
+process_info_provider default_process_info_provider()
+{
+    return { win32_open, win32_close, win32_get_image_path, nullptr };
+}
+#else
+// Field 22 of /proc/<pid>/stat: start time in clock ticks since boot. There is
+// no handle that pins a pid, so entries are rechecked after a revalidation.
+static bool proc_open(void* data, uint32_t pid, uint64_t* start_time, void** handle)
+{
+    (void)data;
+    *handle = nullptr;
+
+    char stat_path[64];
+    snprintf(stat_path, sizeof(stat_path), "/proc/%u/stat", pid);
+
+    FILE* file = fopen(stat_path, "r");
+    if (!file)
+        return false;
+
+    char buffer[1024];
+    size_t length = fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    buffer[length] = '\0';
+
+    // The command name may contain spaces and parentheses; fields resume after the last ')'
+    const char* p = strrchr(buffer, ')');
+    if (!p)
+        return false;
+    p++;
+
+    // Skip fields 3 (state) through 21
+    for (int field = 3; field <= 21; field++) {
+        p = strchr(p + 1, ' ');
+        if (!p)
+            return false;
+    }
+
+    unsigned long long ticks = 0;
+    if (sscanf(p + 1, "%llu", &ticks) != 1)
+        return false;
+
+    *start_time = ticks;
+    return true;
+}
+
+static void proc_close(void* data, void* handle)
+{
+    (void)data;
+    (void)handle;
+}
+
+static bool proc_get_image_path(void* data, uint32_t pid, void* handle, char* path, size_t size)
+{
+    (void)data;
+    (void)handle;
+
+    char exe_link[64];
+    snprintf(exe_link, sizeof(exe_link), "/proc/%u/exe", pid);
+
+    ssize_t length = readlink(exe_link, path, size - 1);
+    if (length <= 0)
+        return false;
+
+    path[length] = '\0';
+    return true;
+}
+
+process_info_provider default_process_info_provider()
+{
+    return { proc_open, proc_close, proc_get_image_path, nullptr };
+}
+#endif
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#define PROCESS_CACHE_CAPACITY 32
+#define PROCESS_EXE_MAX 260
+
+// Platform queries used by the cache. The default provider talks to the OS
+// (OpenProcess on Windows, /proc on Linux); tests and benchmarks can plug in their own.
+struct process_info_provider {
+    // Process creation time in provider-defined units; false if the process is gone.
+    // May also return a handle that keeps pid from being reused while it is open
+    // (nullptr if the platform has none). Called on a miss and, for entries
+    // without a handle, on the first lookup after process_cache_revalidate.
+    bool (*open)(void* data, uint32_t pid, uint64_t* start_time, void** handle);
+    // Releases a handle returned by open
+    void (*close)(void* data, void* handle);
+    // Full path of the process image; only called on a cache miss.
+    bool (*get_image_path)(void* data, uint32_t pid, void* handle, char* path, size_t size);
+    void* data;
+};
+
+struct process_cache_entry {
+    uint32_t pid;
+    uint64_t start_time;
+    void* handle;                // Pins pid while cached; nullptr = check start_time instead
+    uint32_t checked;            // Revalidation epoch start_time was last checked in
+    uint64_t last_used;          // LRU stamp, 0 = slot unused
+    char exe[PROCESS_EXE_MAX];   // Lowercased file name, e.g. "game.exe"
+};
+
+// Bounded LRU from (pid, start time) to normalized executable name. A hit
+// makes no system calls: entries holding a handle can't go stale, and the
+// rest are only rechecked after process_cache_revalidate.
+// Not thread-safe: owned by the thread that runs the window filter.
+struct process_cache {
+    process_cache_entry entries[PROCESS_CACHE_CAPACITY];
+    uint64_t clock;
+    uint32_t epoch;
+
+    // Diagnostics
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+};
+
+void process_cache_init(process_cache* cache);
+
+// Closes every handle held by the cache and empties it
+void process_cache_clear(process_cache* cache, const process_info_provider* provider);
+
+// Cached pids without a handle may have been reused from now on (call when the
+// foreground window changes)
+void process_cache_revalidate(process_cache* cache);
+
+// Returns the lowercased executable name of pid, or nullptr if it can't be
+// determined. The pointer stays valid until the next lookup.
+const char* process_cache_lookup(process_cache* cache, const process_info_provider* provider,
+    uint32_t pid);
+
+process_info_provider default_process_info_provider();
@@ -0,0 +1,125 @@
+#include "secret-redactor.h"
+
+static void reset_state(secret_redactor* redactor)
+{
+    redactor->digit_run = 0;
+    redactor->shown_digits = 0;
+    redactor->last_was_separator = false;
+    redactor->masking_digits = false;
+    redactor->prompt_state = 0;
+    redactor->masked_lines_left = 0;
+}
+
+void secret_redactor_init(secret_redactor* redactor)
+{
+    std::atomic_store(&redactor->config, std::shared_ptr<const secret_redactor_config>());
+    redactor->generation.store(0, std::memory_order_relaxed);
+    redactor->active_generation = 0;
+    redactor->masked = 0;
+    reset_state(redactor);
+}
+
+void secret_redactor_configure(secret_redactor* redactor, uint32_t digit_run_length,
+    const std::string& prompts)
+{
+    auto config = std::make_shared<secret_redactor_config>();
+    config->digit_run_length = digit_run_length > REDACT_MAX_DIGIT_RUN ?
+        REDACT_MAX_DIGIT_RUN : digit_run_length;
+    window_matcher_compile(&config->prompts, prompts, WINDOW_MATCHER_LITERALS);
+
+    std::atomic_store(&redactor->config, std::shared_ptr<const secret_redactor_config>(config));
+    redactor->generation.fetch_add(1, std::memory_order_release);
+}
+
+static void break_digit_run(secret_redactor* redactor)
+{
+    redactor->digit_run = 0;
+    redactor->shown_digits = 0;
+    redactor->last_was_separator = false;
+    redactor->masking_digits = false;
+}
+
+redactor_result secret_redactor_feed(secret_redactor* redactor, redactor_input input, char c)
+{
+    redactor_result result = { false, 0 };
+
+    uint32_t generation = redactor->generation.load(std::memory_order_acquire);
+    auto config = std::atomic_load(&redactor->config);
+    if (!config) {
+        return result;
+    }
+    if (generation != redactor->active_generation) {
+        redactor->active_generation = generation;
+        reset_state(redactor);
+    }
+
+    switch (input) {
+        case REDACTOR_CHAR: {
+            // Prompt triggers: mask everything typed after them
+            if (redactor->masked_lines_left > 0) {
+                result.mask = true;
+            }
+            redactor->prompt_state = window_matcher_step(&config->prompts,
+                redactor->prompt_state, (uint8_t)c);
+            if (window_matcher_state_matches(&config->prompts, redactor->prompt_state)) {
+                // Rest of this line (e.g. "token=...") and the next one (a sudo/mysql prompt)
+                redactor->masked_lines_left = 2;
+            }
+
+            // Digit runs: card numbers, account numbers, one-time codes, ...
+            if (config->digit_run_length > 0) {
+                if (c >= '0' && c <= '9') {
+                    redactor->digit_run++;
+                    redactor->last_was_separator = false;
+
+                    if (redactor->masking_digits) {
+                        result.mask = true;
+                    } else if (redactor->digit_run >= config->digit_run_length) {
+                        // Backspaced digits still show in the history, so
+                        // mask every digit stroke of the run, not just the
+                        // ones left in the text
+                        redactor->masking_digits = true;
+                        result.mask = true;
+                        result.retro_mask = redactor->shown_digits;
+                    } else if (!result.mask) {
+                        redactor->shown_digits++;
+                    }
+                } else if ((c == ' ' || c == '-') && redactor->digit_run > 0 &&
+                           !redactor->last_was_separator) {
+                    redactor->last_was_separator = true;
+                } else {
+                    break_digit_run(redactor);
+                }
+            }
+            break;
+        }
+
+        case REDACTOR_LINE_END:
+            if (redactor->masked_lines_left > 0) {
+                redactor->masked_lines_left--;
+            }
+            redactor->prompt_state = 0;
+            break_digit_run(redactor);
+            break;
+
+        case REDACTOR_BACKSPACE:
+            // Editing inside a secret keeps it a secret
+            if (redactor->digit_run > 0 && !redactor->masking_digits) {
+                redactor->digit_run--;
+            }
+            break;
+
+        case REDACTOR_OTHER:
+            // Clicking into the field or moving the caret doesn't end a
+            // secret; only a line end counts the prompt mask down
+            redactor->prompt_state = 0;
+            break_digit_run(redactor);
+            break;
+    }
+
+    if (result.mask) {
+        redactor->masked++;
+    }
+
+    return result;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "window-matcher.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Longest digit run that can be retroactively masked
+#define REDACT_MAX_DIGIT_RUN 32
+
+// How a keystroke affects the typed-text stream
+enum redactor_input {
+    REDACTOR_CHAR,       // Printable character (shift allowed)
+    REDACTOR_LINE_END,   // Enter / Tab / Esc
+    REDACTOR_BACKSPACE,
+    REDACTOR_OTHER,      // Chords, navigation keys, mouse - breaks runs, keeps prompt masking
+};
+
+struct secret_redactor_config {
+    uint32_t digit_run_length;   // Mask runs of this many digits (0 = off)
+    window_matcher prompts;      // Typed triggers that start masking
+};
+
+struct redactor_result {
+    bool mask;            // Display this keystroke masked
+    uint32_t retro_mask;  // Also mask this many already displayed digits
+};
+
+// Incremental redaction over the typed character stream. Every feed is O(1)
+// with fixed-size state: a digit-run counter and one automaton state for the
+// prompt triggers. Owned by the video thread.
+struct secret_redactor {
+    std::shared_ptr<const secret_redactor_config> config; // std::atomic_load/store only
+    std::atomic<uint32_t> generation;                     // Bumped by secret_redactor_configure
+    uint32_t active_generation;                           // Config the state below belongs to
+
+    uint32_t digit_run;          // Digits in the current run (backspace removes them)
+    uint32_t shown_digits;       // Digit strokes of the run already in the history
+    bool last_was_separator;     // Run tolerates single ' ' / '-' separators
+    bool masking_digits;         // Run reached the threshold
+    uint32_t prompt_state;       // Automaton state over typed text
+    uint32_t masked_lines_left;  // Prompt matched: lines still to mask (current + next)
+
+    // Diagnostics
+    uint64_t masked;
+};
+
+void secret_redactor_init(secret_redactor* redactor);
+
+// Swap in new settings (any thread). State resets on the next feed.
+void secret_redactor_configure(secret_redactor* redactor, uint32_t digit_run_length,
+    const std::string& prompts);
+
+redactor_result secret_redactor_feed(secret_redactor* redactor, redactor_input input, char c);
@@ -0,0 +1,247 @@
+#include "source-target.h"
+#include <obs-module.h>
+#include <algorithm>
+#include <cctype>
+
+// Retry interval while the named source doesn't exist (yet)
+static const std::chrono::seconds resolve_retry_interval(1);
+
+static std::string to_lower(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), ::tolower);
+    return value;
+}
+
+// Undo OBS's window string escaping ("#3A" -> ':', "#22" -> '#')
+static std::string decode_window_field(const std::string& field)
+{
+    std::string decoded;
+    decoded.reserve(field.size());
+
+    for (size_t i = 0; i < field.size(); i++) {
+        if (field[i] == '#' && i + 2 < field.size()) {
+            if (field.compare(i, 3, "#3A") == 0) {
+                decoded += ':';
+                i += 2;
+                continue;
+            }
+            if (field.compare(i, 3, "#22") == 0) {
+                decoded += '#';
+                i += 2;
+                continue;
+            }
+        }
+        decoded += field[i];
+    }
+
+    return decoded;
+}
+
+void parse_window_setting(const char* setting, std::string& title,
+    std::string& window_class, std::string& exe)
+{
+    title.clear();
+    window_class.clear();
+    exe.clear();
+
+    if (!setting)
+        return;
+
+    std::string value(setting);
+    size_t first_colon = value.find(':');
+    if (first_colon == std::string::npos) {
+        title = decode_window_field(value);
+        return;
+    }
+
+    size_t second_colon = value.find(':', first_colon + 1);
+    title = decode_window_field(value.substr(0, first_colon));
+    if (second_colon == std::string::npos) {
+        window_class = decode_window_field(value.substr(first_colon + 1));
+        return;
+    }
+
+    window_class = decode_window_field(value.substr(first_colon + 1, second_colon - first_colon - 1));
+    exe = decode_window_field(value.substr(second_colon + 1));
+}
+
+static std::shared_ptr<const source_target_snapshot> build_snapshot(obs_source_t* source)
+{
+    auto snapshot = std::make_shared<source_target_snapshot>();
+    const char* source_id = obs_source_get_id(source);
+    obs_data_t* settings = obs_source_get_settings(source);
+
+    if (strcmp(source_id, "monitor_capture") == 0) {
+        snapshot->kind = SOURCE_TARGET_MONITOR;
+        snapshot->monitor_id = obs_data_get_string(settings, "monitor_id");
+    } else if (strcmp(source_id, "window_capture") == 0 ||
+               strcmp(source_id, "game_capture") == 0) {
+        snapshot->kind = strcmp(source_id, "window_capture") == 0 ?
+            SOURCE_TARGET_WINDOW : SOURCE_TARGET_GAME;
+
+        std::string title, window_class, exe;
+        parse_window_setting(obs_data_get_string(settings, "window"), title, window_class, exe);
+        snapshot->title = to_lower(title);
+        snapshot->window_class = window_class;
+        snapshot->exe = to_lower(exe);
+    } else if (strcmp(source_id, "xcomposite_input") == 0) {
+        // Linux window capture: "capture_window" is "<xid>\r\n<title>\r\n<class>"
+        snapshot->kind = SOURCE_TARGET_WINDOW;
+
+        std::string value = obs_data_get_string(settings, "capture_window");
+        size_t title_start = value.find("\r\n");
+        size_t class_start = title_start == std::string::npos ?
+            std::string::npos : value.find("\r\n", title_start + 2);
+        if (class_start != std::string::npos) {
+            snapshot->title = to_lower(value.substr(title_start + 2, class_start - title_start - 2));
+            snapshot->window_class = value.substr(class_start + 2);
+        }
+    } else {
+        snapshot->kind = SOURCE_TARGET_UNSUPPORTED;
+    }
+
+    obs_data_release(settings);
+
+    blog(LOG_INFO, "[SOURCE-FILTER] Snapshot of '%s' (type: %s): title='%s' exe='%s' monitor='%s'",
+         obs_source_get_name(source), source_id, snapshot->title.c_str(),
+         snapshot->exe.c_str(), snapshot->monitor_id.c_str());
+
+    return snapshot;
+}
+
+static void publish_snapshot(source_target_resolver* resolver,
+    std::shared_ptr<const source_target_snapshot> snapshot)
+{
+    std::atomic_store(&resolver->snapshot, std::move(snapshot));
+    if (resolver->changed) {
+        resolver->changed(resolver->changed_data);
+    }
+}
+
+static void source_target_updated(void* data, calldata_t* cd)
+{
+    source_target_resolver* resolver = static_cast<source_target_resolver*>(data);
+    obs_source_t* source = static_cast<obs_source_t*>(calldata_ptr(cd, "source"));
+
+    if (!source || resolver->lost.load(std::memory_order_acquire))
+        return;
+
+    publish_snapshot(resolver, build_snapshot(source));
+}
+
+static void source_target_lost(void* data, calldata_t* cd)
+{
+    UNUSED_PARAMETER(cd);
+    source_target_resolver* resolver = static_cast<source_target_resolver*>(data);
+
+    // The configured name no longer refers to this source. Don't disconnect
+    // from inside the signal; source_target_poll cleans up and re-resolves.
+    resolver->lost.store(true, std::memory_order_release);
+    publish_snapshot(resolver, nullptr);
+}
+
+static void connect_signals(source_target_resolver* resolver, obs_source_t* source, bool connect)
+{
+    signal_handler_t* handler = obs_source_get_signal_handler(source);
+    if (!handler)
+        return;
+
+    if (connect) {
+        signal_handler_connect(handler, "update", source_target_updated, resolver);
+        signal_handler_connect(handler, "rename", source_target_lost, resolver);
+        signal_handler_connect(handler, "remove", source_target_lost, resolver);
+    } else {
+        signal_handler_disconnect(handler, "update", source_target_updated, resolver);
+        signal_handler_disconnect(handler, "rename", source_target_lost, resolver);
+        signal_handler_disconnect(handler, "remove", source_target_lost, resolver);
+    }
+}
+
+static void detach(source_target_resolver* resolver)
+{
+    if (resolver->weak_source) {
+        obs_source_t* source = obs_weak_source_get_source(resolver->weak_source);
+        if (source) {
+            connect_signals(resolver, source, false);
+            obs_source_release(source);
+        }
+        obs_weak_source_release(resolver->weak_source);
+        resolver->weak_source = nullptr;
+    }
+
+    resolver->resolved_name.clear();
+    resolver->lost.store(false, std::memory_order_release);
+}
+
+void source_target_init(source_target_resolver* resolver, void (*changed)(void*), void* data)
+{
+    resolver->name_dirty = false;
+    resolver->weak_source = nullptr;
+    resolver->next_retry = std::chrono::steady_clock::time_point();
+    resolver->lost.store(false, std::memory_order_relaxed);
+    resolver->changed = changed;
+    resolver->changed_data = data;
+    std::atomic_store(&resolver->snapshot, std::shared_ptr<const source_target_snapshot>());
+}
+
+void source_target_free(source_target_resolver* resolver)
+{
+    detach(resolver);
+    std::atomic_store(&resolver->snapshot, std::shared_ptr<const source_target_snapshot>());
+}
+
+void source_target_set_name(source_target_resolver* resolver, const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(resolver->name_mutex);
+    if (name != resolver->wanted_name) {
+        resolver->wanted_name = name;
+        resolver->name_dirty = true;
+    }
+}
+
+void source_target_poll(source_target_resolver* resolver)
+{
+    std::string wanted;
+    bool name_changed;
+    {
+        std::lock_guard<std::mutex> lock(resolver->name_mutex);
+        wanted = resolver->wanted_name;
+        name_changed = resolver->name_dirty;
+        resolver->name_dirty = false;
+    }
+
+    if (name_changed || resolver->lost.load(std::memory_order_acquire)) {
+        if (resolver->weak_source) {
+            blog(LOG_INFO, "[SOURCE-FILTER] Stopped monitoring '%s'", resolver->resolved_name.c_str());
+        }
+        detach(resolver);
+        publish_snapshot(resolver, nullptr);
+        resolver->next_retry = std::chrono::steady_clock::time_point();
+    }
+
+    if (resolver->weak_source || wanted.empty())
+        return;
+
+    // Not resolved yet - look the source up, but not on every frame
+    auto now = std::chrono::steady_clock::now();
+    if (now < resolver->next_retry)
+        return;
+    resolver->next_retry = now + resolve_retry_interval;
+
+    obs_source_t* source = obs_get_source_by_name(wanted.c_str());
+    if (!source) {
+        blog(LOG_DEBUG, "[SOURCE-FILTER] Source '%s' not found", wanted.c_str());
+        return;
+    }
+
+    resolver->weak_source = obs_source_get_weak_source(source);
+    resolver->resolved_name = wanted;
+    connect_signals(resolver, source, true);
+    publish_snapshot(resolver, build_snapshot(source));
+    obs_source_release(source);
+}
+
+std::shared_ptr<const source_target_snapshot> source_target_get(source_target_resolver* resolver)
+{
+    return std::atomic_load(&resolver->snapshot);
+}
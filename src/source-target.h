@@ -0,0 +1,64 @@
+#pragma once
+
+#include <obs.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+
+enum source_target_kind {
+    SOURCE_TARGET_UNSUPPORTED,
+    SOURCE_TARGET_MONITOR,  // monitor_capture
+    SOURCE_TARGET_WINDOW,   // window_capture, xcomposite_input
+    SOURCE_TARGET_GAME,     // game_capture
+};
+
+// Parsed settings of the monitored OBS capture source. Immutable once published.
+struct source_target_snapshot {
+    source_target_kind kind;
+    std::string title;         // Lowercased window title
+    std::string window_class;
+    std::string exe;           // Lowercased executable name
+    std::string monitor_id;    // Display capture device id
+};
+
+// Keeps a prebuilt snapshot of the capture source named in the settings.
+// The snapshot is rebuilt only when that source fires its "update" signal and
+// dropped on "rename"/"remove", so the input hooks never call into libobs.
+struct source_target_resolver {
+    // Written by keystroke_source_update
+    std::mutex name_mutex;
+    std::string wanted_name;
+    bool name_dirty;
+
+    // Owned by the video thread (source_target_poll)
+    std::string resolved_name;
+    obs_weak_source_t* weak_source;
+    std::chrono::steady_clock::time_point next_retry;
+
+    // Shared with the signal handlers and the hooks
+    std::atomic<bool> lost;
+    std::shared_ptr<const source_target_snapshot> snapshot; // std::atomic_load/store only
+
+    // Called (from any thread) whenever the published snapshot changes
+    void (*changed)(void* data);
+    void* changed_data;
+};
+
+void source_target_init(source_target_resolver* resolver, void (*changed)(void*), void* data);
+void source_target_free(source_target_resolver* resolver);
+
+// Select the source to monitor by name (empty = none). Takes effect on the next poll.
+void source_target_set_name(source_target_resolver* resolver, const std::string& name);
+
+// Connects to the named source if needed and reconnects after rename/remove.
+// Call from the video tick.
+void source_target_poll(source_target_resolver* resolver);
+
+// Current snapshot, or nullptr if the source isn't resolved. Safe from any thread.
+std::shared_ptr<const source_target_snapshot> source_target_get(source_target_resolver* resolver);
+
+// Split an OBS window setting ("title:class:exe", ':' escaped as "#3A") into its parts
+void parse_window_setting(const char* setting, std::string& title,
+    std::string& window_class, std::string& exe);
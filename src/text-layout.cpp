@@ -0,0 +1,74 @@
+#include "text-layout.h"
+
+void decode_utf8(const char* text, size_t size, std::vector<uint32_t>& out)
+{
+    out.clear();
+
+    size_t i = 0;
+    const size_t n = size;
+    while (i < n) {
+        uint8_t c = (uint8_t)text[i];
+        uint32_t codepoint;
+        size_t length;
+
+        if (c < 0x80) {
+            codepoint = c;
+            length = 1;
+        } else if ((c & 0xE0) == 0xC0) {
+            codepoint = c & 0x1F;
+            length = 2;
+        } else if ((c & 0xF0) == 0xE0) {
+            codepoint = c & 0x0F;
+            length = 3;
+        } else if ((c & 0xF8) == 0xF0) {
+            codepoint = c & 0x07;
+            length = 4;
+        } else {
+            out.push_back(0xFFFD);
+            i++;
+            continue;
+        }
+
+        bool valid = i + length <= n;
+        for (size_t k = 1; valid && k < length; k++) {
+            uint8_t next = (uint8_t)text[i + k];
+            if ((next & 0xC0) != 0x80) {
+                valid = false;
+            } else {
+                codepoint = (codepoint << 6) | (next & 0x3F);
+            }
+        }
+
+        if (!valid) {
+            out.push_back(0xFFFD);
+            i++;
+            continue;
+        }
+
+        out.push_back(codepoint);
+        i += length;
+    }
+}
+
+std::shared_ptr<const text_layout> text_layout_create(const std::shared_ptr<font_face>& face,
+    const char* text, size_t size)
+{
+    if (!face)
+        return nullptr;
+
+    auto layout = std::make_shared<text_layout>();
+    layout->face = face;
+    layout->ascent = face->metrics.ascent;
+    layout->descent = face->metrics.descent;
+    decode_utf8(text, size, layout->codepoints);
+
+    float pen = 0.0f;
+    layout->offsets.reserve(layout->codepoints.size());
+    for (uint32_t codepoint : layout->codepoints) {
+        layout->offsets.push_back(pen);
+        pen += font_face_advance(face.get(), codepoint);
+    }
+    layout->width = pen;
+
+    return layout;
+}
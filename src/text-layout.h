@@ -0,0 +1,26 @@
+#pragma once
+
+#include "font-cache.h"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Positioned glyph run for one history entry. Built once whenever the entry's
+// text or the font changes, then shared read-only with the layout worker.
+// Glyphs map 1:1 to codepoints (no complex shaping), which covers the key
+// names and typed text this source displays.
+struct text_layout {
+    std::shared_ptr<font_face> face;   // Font the run was measured with
+    std::vector<uint32_t> codepoints;
+    std::vector<float> offsets;        // Pen x of each glyph from the line start
+    float width;                       // Total advance
+    int ascent;                        // Line box: width x (ascent + descent)
+    int descent;
+};
+
+// nullptr if there is no font
+std::shared_ptr<const text_layout> text_layout_create(const std::shared_ptr<font_face>& face,
+    const char* text, size_t size);
+
+// Invalid sequences become U+FFFD so one bad byte can't swallow a line
+void decode_utf8(const char* text, size_t size, std::vector<uint32_t>& out);
@@ -1,283 +1,649 @@
 #include "text-renderer.h"
 #include <obs-module.h>
 #include <graphics/graphics.h>
+#include <graphics/vec4.h>
+#include <util/bmem.h>
 #include <util/platform.h>
+#include <cmath>
+#include <cstring>
 #include <vector>
 #include <string>
-#include <windows.h>
-#include <wingdi.h>
 
-// Use plain GDI (not GDI+) for text rendering - much more stable
+static void render_worker(text_renderer* renderer);
 
-void render_text_to_texture(keystroke_source* context)
+text_renderer* text_renderer_create()
 {
-    if (!context) {
-        blog(LOG_ERROR, "[RENDER] context is null");
-        return;
+    text_renderer* renderer = new text_renderer();
+    glyph_atlas_init(&renderer->atlas);
+    line_cache_init(&renderer->lines, LINE_CACHE_BUDGET);
+    renderer->lines_epoch = renderer->atlas.epoch;
+    renderer->atlas_revision = 0;
+    renderer->stopping = false;
+    renderer->ready_frame = -1;
+    renderer->reading_frame = -1;
+    renderer->uploaded_atlas_revision.store(0);
+    renderer->requests_coalesced = 0;
+    renderer->frames_dropped = 0;
+    renderer->has_content = false;
+    renderer->text_color = 0xFFFFFFFF;
+    renderer->background_color = 0;
+    renderer->built_generation = 0;
+    renderer->alpha_generation = 0;
+    renderer->rebuilds_performed = 0;
+    renderer->rebuilds_skipped = 0;
+    renderer->effect = nullptr;
+    renderer->atlas_texture = nullptr;
+    renderer->texture_height = 0;
+    for (int i = 0; i < TEXT_VERTEX_BUFFERS; i++) {
+        renderer->buffers[i] = {};
     }
-    
-    // Copy entries while holding the lock briefly
-    std::vector<keystroke_entry> entries_copy;
-    try {
-        std::lock_guard<std::mutex> lock(context->entries_mutex);
-        entries_copy = context->entries;
-    } catch (const std::exception& e) {
-        blog(LOG_ERROR, "[RENDER] Exception during copy: %s", e.what());
-        return;
-    } catch (...) {
-        blog(LOG_ERROR, "[RENDER] Unknown exception during copy");
+    renderer->current_buffer = -1;
+    renderer->texture_allocations = 0;
+    renderer->buffer_allocations = 0;
+    renderer->graphics_lock_ns = 0;
+    renderer->graphics_lock_max_ns = 0;
+    renderer->atlas_bytes_uploaded = 0;
+
+    char* effect_path = obs_module_file("keystroke-text.effect");
+    if (effect_path) {
+        obs_enter_graphics();
+        renderer->effect = gs_effect_create_from_file(effect_path, nullptr);
+        obs_leave_graphics();
+        bfree(effect_path);
+    }
+
+    if (!renderer->effect) {
+        blog(LOG_ERROR, "[RENDER] Failed to load keystroke-text.effect");
+    }
+
+    renderer->worker = std::thread(render_worker, renderer);
+    return renderer;
+}
+
+void text_renderer_destroy(text_renderer* renderer)
+{
+    if (!renderer)
         return;
+
+    {
+        std::lock_guard<std::mutex> lock(renderer->frame_mutex);
+        renderer->stopping = true;
+    }
+    renderer->wake.notify_one();
+    if (renderer->worker.joinable())
+        renderer->worker.join();
+
+    if (renderer->rebuilds_performed + renderer->rebuilds_skipped > 0) {
+        blog(LOG_INFO, "[RENDER] %llu rebuilds, %llu unchanged frames skipped",
+             (unsigned long long)renderer->rebuilds_performed,
+             (unsigned long long)renderer->rebuilds_skipped);
+        blog(LOG_INFO, "[RENDER] Worker: %llu snapshots coalesced, %llu finished frames dropped",
+             (unsigned long long)renderer->requests_coalesced,
+             (unsigned long long)renderer->frames_dropped);
+        blog(LOG_INFO, "[RENDER] %llu texture / %llu vertex buffer allocations, "
+             "%llu KiB of atlas uploaded, graphics lock held %.3f ms total (max %.3f ms)",
+             (unsigned long long)renderer->texture_allocations,
+             (unsigned long long)renderer->buffer_allocations,
+             (unsigned long long)(renderer->atlas_bytes_uploaded / 1024),
+             renderer->graphics_lock_ns / 1000000.0,
+             renderer->graphics_lock_max_ns / 1000000.0);
+    }
+
+    const line_cache* lines = &renderer->lines;
+    if (lines->hits + lines->misses > 0) {
+        blog(LOG_INFO, "[RENDER] Line cache: %llu hits, %llu misses (%.1f%% hit rate), "
+             "%llu evictions, peak %zu of %zu KiB",
+             (unsigned long long)lines->hits, (unsigned long long)lines->misses,
+             100.0 * lines->hits / (double)(lines->hits + lines->misses),
+             (unsigned long long)lines->evictions,
+             lines->peak_bytes / 1024, lines->budget / 1024);
     }
-    
-    if (entries_copy.empty()) {
-        // Clear texture if no entries
-        if (context->texture) {
-            obs_enter_graphics();
-            gs_texture_destroy(context->texture);
-            context->texture = nullptr;
-            obs_leave_graphics();
+
+    obs_enter_graphics();
+    gs_effect_destroy(renderer->effect);
+    gs_texture_destroy(renderer->atlas_texture);
+    for (int i = 0; i < TEXT_VERTEX_BUFFERS; i++) {
+        gs_vertexbuffer_destroy(renderer->buffers[i].vertex_buffer);
+    }
+    obs_leave_graphics();
+
+    glyph_atlas_free(&renderer->atlas);
+    delete renderer;
+}
+
+static void push_quad(std::vector<text_vertex>& vertices, float x, float y,
+    const atlas_glyph* glyph)
+{
+    float x1 = x + glyph->width;
+    float y1 = y + glyph->height;
+    float u0 = glyph->x;
+    float v0 = glyph->y;
+    float u1 = u0 + glyph->width;
+    float v1 = v0 + glyph->height;
+
+    vertices.push_back({ x,  y,  u0, v0 });
+    vertices.push_back({ x1, y,  u1, v0 });
+    vertices.push_back({ x,  y1, u0, v1 });
+    vertices.push_back({ x1, y,  u1, v0 });
+    vertices.push_back({ x1, y1, u1, v1 });
+    vertices.push_back({ x,  y1, u0, v1 });
+}
+
+// Lay out one line with its top at y = 0; returns false if the atlas ran out of room
+static bool layout_line(const text_layout_request& request, text_renderer* renderer,
+    const keystroke_entry& entry, int line_height, int left, int right,
+    std::vector<text_vertex>& out)
+{
+    glyph_atlas* atlas = &renderer->atlas;
+
+    // Entries are measured whenever their text or the font changes; the
+    // fallback only covers a snapshot taken mid-switch
+    std::shared_ptr<const text_layout> layout = entry.layout;
+    if (!layout || layout->face != atlas->face)
+        layout = text_layout_create(atlas->face, entry.text.c_str(), entry.text.size());
+    if (!layout)
+        return true;
+
+    float start = (float)left;
+    if (request.text_alignment == "center") {
+        start = left + ((right - left) - layout->width) * 0.5f;
+    } else if (request.text_alignment == "right") {
+        start = right - layout->width;
+    }
+    start = floorf(start);
+
+    // Vertically centered in the row, like DT_VCENTER
+    int text_height = layout->ascent + layout->descent;
+    int baseline = (line_height - text_height) / 2 + layout->ascent;
+
+    for (size_t i = 0; i < layout->codepoints.size(); i++) {
+        const atlas_glyph* glyph = glyph_atlas_get(atlas, layout->codepoints[i]);
+        if (!glyph)
+            return false;
+
+        if (glyph->width > 0) {
+            float x = floorf(start + layout->offsets[i]) + glyph->bearing_x;
+            float y = (float)(baseline - glyph->bearing_y);
+            if (x + glyph->width > right)
+                break; // Clip like the text rectangle did
+            push_quad(out, x, y, glyph);
         }
-        return;
     }
-    
+
+    return true;
+}
+
+static bool layout_entries(const text_layout_request& request, text_renderer* renderer,
+    int width, int line_height, int padding, int max_lines, text_frame* frame)
+{
+    std::vector<text_vertex>& out = frame->vertices;
+    out.clear();
+    frame->lines.clear();
+
+    // If display_newest_on_top is true, entries run top to bottom from the top edge
+    // If display_newest_on_top is false, the newest entry is anchored at the bottom
+    const std::vector<keystroke_entry>& entries = request.entries;
+    const int count = (int)entries.size();
+    for (int i = 0; i < count; i++) {
+        int row = request.display_newest_on_top ? i : max_lines - count + i;
+        if (row < 0 || row >= max_lines)
+            continue;
+
+        // Everything that changes the quads of a line is part of its key
+        std::string& key = renderer->line_key;
+        key.clear();
+        key += request.font->name;
+        key += '\0';
+        key += std::to_string(request.font->size) + ':' + std::to_string(request.font->weight) +
+               ':' + request.text_alignment + ':' + std::to_string(width) + ':' +
+               std::to_string(line_height) + ':' + std::to_string(padding);
+        key += '\0';
+        key.append(entries[i].text.c_str(), entries[i].text.size());
+
+        const std::vector<text_vertex>* line = line_cache_find(&renderer->lines, key);
+        if (!line) {
+            std::vector<text_vertex> fresh;
+            if (!layout_line(request, renderer, entries[i], line_height,
+                    padding, width - padding, fresh))
+                return false;
+            line = line_cache_insert(&renderer->lines, key, std::move(fresh));
+        }
+
+        // Compose: copy the cached run, moved down to this row
+        const float top = (float)(padding + row * line_height);
+        text_frame_line span = { entries[i].id, (uint32_t)out.size(), (uint32_t)line->size(), row };
+        for (const text_vertex& vertex : *line) {
+            text_vertex placed = vertex;
+            placed.y += top;
+            out.push_back(placed);
+        }
+        frame->lines.push_back(span);
+    }
+
+    return true;
+}
+
+// Worker: turn one snapshot into a frame
+static void build_frame(text_renderer* renderer, const text_layout_request& request,
+    text_frame* frame)
+{
+    frame->vertices.clear();
+    frame->lines.clear();
+    frame->has_atlas = false;
+    frame->has_content = false;
+
+    if (request.entries.empty() || !request.font)
+        return;
+
     // Calculate dimensions based on text
-    int line_height = context->font_size + 8;
+    int line_height = request.font_size + 8;
     int padding = 10;
     int width = 600;  // Fixed width for now
-    
+
     // Use max_entries to determine a fixed height, so the source doesn't jump around
     // This allows users to anchor it properly in their scene
-    int max_lines = context->max_entries > 0 ? context->max_entries : 10; // Default to 10 if not set
+    int max_lines = request.max_entries > 0 ? request.max_entries : 10; // Default to 10 if not set
     int height = line_height * max_lines + padding * 2;
-    
-    blog(LOG_INFO, "[RENDER] Dimensions: %dx%d (max_entries=%d)", width, height, max_lines);
-    
-    if (width <= 0 || height <= 0) {
-        blog(LOG_WARNING, "[RENDER] Invalid dimensions: %dx%d", width, height);
-        return;
+
+    glyph_atlas_set_face(&renderer->atlas, request.font);
+
+    // Cached lines point at atlas texels; drop them when the atlas starts over
+    if (renderer->lines_epoch != renderer->atlas.epoch) {
+        line_cache_clear(&renderer->lines);
+        renderer->lines_epoch = renderer->atlas.epoch;
     }
-    
-    // Create GDI bitmap for rendering text
-    HDC hdc = CreateCompatibleDC(NULL);
-    if (!hdc) {
-        blog(LOG_ERROR, "[RENDER] Failed to create DC");
-        return;
+
+    if (!layout_entries(request, renderer, width, line_height, padding, max_lines, frame)) {
+        // Atlas full at its maximum size: start over with only what is on screen
+        glyph_atlas_clear(&renderer->atlas);
+        line_cache_clear(&renderer->lines);
+        renderer->lines_epoch = renderer->atlas.epoch;
+        layout_entries(request, renderer, width, line_height, padding, max_lines, frame);
     }
-    
-    BITMAPINFO bmi = {};
-    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
-    bmi.bmiHeader.biWidth = width;
-    bmi.bmiHeader.biHeight = -height; // Negative for top-down bitmap
-    bmi.bmiHeader.biPlanes = 1;
-    bmi.bmiHeader.biBitCount = 32;
-    bmi.bmiHeader.biCompression = BI_RGB;
-    
-    uint32_t* pixels = nullptr;
-    HBITMAP hBitmap = CreateDIBSection(hdc, &bmi, DIB_RGB_COLORS, (void**)&pixels, NULL, 0);
-    
-    if (!hBitmap || !pixels) {
-        blog(LOG_ERROR, "[RENDER] Failed to create bitmap");
-        DeleteDC(hdc);
-        return;
+
+    glyph_atlas* atlas = &renderer->atlas;
+    if (atlas->dirty) {
+        renderer->atlas_revision++;
+        atlas->dirty = false;
     }
-    
-    HBITMAP hOldBitmap = (HBITMAP)SelectObject(hdc, hBitmap);
-    
-    // Extract background color components (ARGB format from settings)
-    uint32_t bg_color = context->background_color;
-    int bg_alpha = context->show_background ? (int)(context->background_opacity * 255.0f) : 0;
-    int bg_r = (bg_color >> 16) & 0xFF;
-    int bg_g = (bg_color >> 8) & 0xFF;
-    int bg_b = bg_color & 0xFF;
-    
-    // Extract text color for later use
-    uint32_t text_color = context->font_color;
-    int text_r = (text_color >> 16) & 0xFF;
-    int text_g = (text_color >> 8) & 0xFF;
-    int text_b = text_color & 0xFF;
-    
-    // Fill background with a contrasting color when background is transparent
-    // This allows us to detect where text was drawn
-    uint8_t fill_r, fill_g, fill_b;
-    if (context->show_background) {
-        // Use actual background color
-        fill_r = bg_r;
-        fill_g = bg_g;
-        fill_b = bg_b;
-    } else {
-        // Use a color that contrasts with text for detection purposes
-        // Use inverse of text color to ensure maximum contrast
-        fill_r = 255 - text_r;
-        fill_g = 255 - text_g;
-        fill_b = 255 - text_b;
+
+    // Ship the atlas until the tick has uploaded this revision (frames can be dropped).
+    // Rows below the packed glyphs are never sampled, so only the used band goes.
+    frame->atlas_rows = glyph_atlas_used_rows(atlas);
+    if (renderer->atlas_revision != renderer->uploaded_atlas_revision.load(std::memory_order_acquire)) {
+        frame->atlas_pixels.assign(atlas->pixels.begin(),
+            atlas->pixels.begin() + (size_t)atlas->width * frame->atlas_rows);
+        frame->has_atlas = true;
     }
-    
-    // Fill bitmap with fill color
-    for (int i = 0; i < width * height; i++) {
-        pixels[i] = (fill_b) | (fill_g << 8) | (fill_r << 16) | (0 << 24); // Start with alpha=0
+
+    frame->atlas_width = atlas->width;
+    frame->atlas_height = atlas->height;
+    frame->atlas_revision = renderer->atlas_revision;
+    frame->cx = width;
+    frame->cy = height;
+    frame->line_height = line_height;
+    frame->has_content = true;
+}
+
+static void render_worker(text_renderer* renderer)
+{
+    os_set_thread_name("keystroke-history: text layout");
+
+    for (;;) {
+        std::unique_ptr<text_layout_request> request;
+        int slot;
+        {
+            std::unique_lock<std::mutex> lock(renderer->frame_mutex);
+            renderer->wake.wait(lock, [renderer] { return renderer->stopping || renderer->pending; });
+            if (renderer->stopping)
+                return;
+            request = std::move(renderer->pending);
+
+            // Write the frame the tick isn't uploading; an unread one there is stale now
+            if (renderer->reading_frame >= 0) {
+                slot = 1 - renderer->reading_frame;
+            } else {
+                slot = renderer->ready_frame == 0 ? 1 : 0;
+            }
+            if (renderer->ready_frame == slot) {
+                renderer->ready_frame = -1;
+                renderer->frames_dropped++;
+            }
+        }
+
+        build_frame(renderer, *request, &renderer->frames[slot]);
+        renderer->rebuilds_performed++;
+
+        std::lock_guard<std::mutex> lock(renderer->frame_mutex);
+        if (renderer->ready_frame >= 0)
+            renderer->frames_dropped++;
+        renderer->ready_frame = slot;
     }
-    
-    // Create font - Use CreateFontW for Unicode support
-    // Convert font name from UTF-8 to wide string
-    int wchars_needed = MultiByteToWideChar(CP_UTF8, 0, context->font_name.c_str(), -1, NULL, 0);
-    std::wstring font_name_wide(wchars_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, context->font_name.c_str(), -1, &font_name_wide[0], wchars_needed);
-    
-    HFONT hFont = CreateFontW(
-        context->font_size,           // Height
-        0,                            // Width (auto)
-        0,                            // Escapement
-        0,                            // Orientation
-        FW_NORMAL,                    // Weight
-        FALSE,                        // Italic
-        FALSE,                        // Underline
-        FALSE,                        // Strikeout
-        DEFAULT_CHARSET,              // Charset
-        OUT_DEFAULT_PRECIS,           // Output precision
-        CLIP_DEFAULT_PRECIS,          // Clipping precision
-        ANTIALIASED_QUALITY,          // Quality
-        DEFAULT_PITCH | FF_DONTCARE,  // Pitch and family
-        font_name_wide.c_str()        // Font name
-    );
-    
-    if (!hFont) {
-        blog(LOG_ERROR, "[RENDER] Failed to create font");
-        SelectObject(hdc, hOldBitmap);
-        DeleteObject(hBitmap);
-        DeleteDC(hdc);
+}
+
+static void upload_atlas(text_renderer* renderer, const text_frame* frame)
+{
+    if (!frame->has_atlas)
         return;
+
+    // Only a grown atlas needs a new texture; new glyphs are written in place
+    if (renderer->atlas_texture && renderer->texture_height != frame->atlas_height) {
+        gs_texture_destroy(renderer->atlas_texture);
+        renderer->atlas_texture = nullptr;
     }
-    
-    HFONT hOldFont = (HFONT)SelectObject(hdc, hFont);
-    
-    SetTextColor(hdc, RGB(text_r, text_g, text_b));
-    
-    // Always use OPAQUE mode so GDI anti-aliasing works properly
-    SetBkMode(hdc, OPAQUE);
-    if (context->show_background) {
-        SetBkColor(hdc, RGB(bg_r, bg_g, bg_b));
-    } else {
-        // Use the inverse color as background for rendering
-        // This ensures text is always detectable regardless of text color
-        SetBkColor(hdc, RGB(fill_r, fill_g, fill_b));
+
+    if (!renderer->atlas_texture) {
+        renderer->atlas_texture = gs_texture_create(frame->atlas_width, frame->atlas_height,
+            GS_R8, 1, nullptr, GS_DYNAMIC);
+        renderer->texture_height = frame->atlas_height;
+        renderer->texture_allocations++;
     }
-    
-    // Determine text alignment flags
-    UINT alignment_flags = DT_VCENTER | DT_SINGLELINE;
-    if (context->text_alignment == "center") {
-        alignment_flags |= DT_CENTER;
-    } else if (context->text_alignment == "right") {
-        alignment_flags |= DT_RIGHT;
-    } else {
-        alignment_flags |= DT_LEFT; // Default
+
+    if (!renderer->atlas_texture) {
+        blog(LOG_ERROR, "[RENDER] Failed to create glyph atlas texture");
+        return;
     }
-    
-    // Render each entry
-    // If display_newest_on_top is true, render from top to bottom starting at padding
-    // If display_newest_on_top is false, render from bottom to top, anchoring at the bottom
-    
-    if (context->display_newest_on_top) {
-        // Newest at top: render entries forward (0 to N), starting from top
-        int y_pos = padding;
-        for (size_t i = 0; i < entries_copy.size(); i++) {
-            const auto& entry = entries_copy[i];
-            
-            // Convert UTF-8 string to wide string for Unicode rendering
-            int wchars_needed = MultiByteToWideChar(CP_UTF8, 0, entry.text.c_str(), -1, NULL, 0);
-            std::wstring text_wide(wchars_needed, 0);
-            MultiByteToWideChar(CP_UTF8, 0, entry.text.c_str(), -1, &text_wide[0], wchars_needed);
-            
-            RECT rect = { padding, y_pos, width - padding, y_pos + line_height };
-            DrawTextW(hdc, text_wide.c_str(), -1, &rect, alignment_flags);
-            
-            y_pos += line_height;
-        }
-    } else {
-        // Newest at bottom: render from bottom upward
-        // Start at the bottom edge and work upward
-        // Entries are stored [oldest...newest], so we render backwards (newest to oldest)
-        // This places newest at bottom, oldest at top
-        int y_pos = height - padding - line_height;
-        
-        // Render entries in reverse order (newest to oldest) from bottom upward
-        for (int i = (int)entries_copy.size() - 1; i >= 0; i--) {
-            const auto& entry = entries_copy[i];
-            
-            // Convert UTF-8 string to wide string for Unicode rendering
-            int wchars_needed = MultiByteToWideChar(CP_UTF8, 0, entry.text.c_str(), -1, NULL, 0);
-            std::wstring text_wide(wchars_needed, 0);
-            MultiByteToWideChar(CP_UTF8, 0, entry.text.c_str(), -1, &text_wide[0], wchars_needed);
-            
-            RECT rect = { padding, y_pos, width - padding, y_pos + line_height };
-            DrawTextW(hdc, text_wide.c_str(), -1, &rect, alignment_flags);
-            
-            y_pos -= line_height;  // Move UP for the next (older) entry
+
+    // A failed map leaves the revision unrecorded, so the worker keeps
+    // shipping the atlas and the next frame tries again
+    uint8_t* texels;
+    uint32_t linesize;
+    if (!gs_texture_map(renderer->atlas_texture, &texels, &linesize))
+        return;
+
+    // Write only the rows holding glyphs; the rest is never sampled
+    const uint8_t* src = frame->atlas_pixels.data();
+    for (uint32_t row = 0; row < frame->atlas_rows; row++) {
+        memcpy(texels + (size_t)row * linesize, src + (size_t)row * frame->atlas_width,
+            frame->atlas_width);
+    }
+    gs_texture_unmap(renderer->atlas_texture);
+    renderer->atlas_bytes_uploaded += frame->atlas_pixels.size();
+
+    renderer->uploaded_atlas_revision.store(frame->atlas_revision, std::memory_order_release);
+}
+
+static gs_vertbuffer_t* create_vertex_buffer(size_t capacity)
+{
+    struct gs_vb_data* vb = gs_vbdata_create();
+    vb->num = capacity;
+    vb->points = (struct vec3*)bzalloc(sizeof(struct vec3) * capacity);
+    vb->num_tex = 1;
+    vb->tvarray = (struct gs_tvertarray*)bzalloc(sizeof(struct gs_tvertarray));
+    vb->tvarray[0].width = 2;
+    vb->tvarray[0].array = bzalloc(sizeof(struct vec2) * capacity);
+
+    return gs_vertexbuffer_create(vb, GS_DYNAMIC);
+}
+
+// Fill the buffer the last draw did not use. Returns its slot, or -1.
+static int prepare_vertices(text_renderer* renderer, const text_frame* frame)
+{
+    const size_t count = frame->vertices.size();
+    const int slot = (renderer->current_buffer + 1) % TEXT_VERTEX_BUFFERS;
+    text_vertex_buffer* buffer = &renderer->buffers[slot];
+
+    if (count > buffer->capacity) {
+        size_t capacity = buffer->capacity ? buffer->capacity : 6 * 64;
+        while (capacity < count)
+            capacity *= 2;
+
+        // Growing is rare (longer lines or more entries), so it gets its own lock
+        uint64_t lock_start = os_gettime_ns();
+        obs_enter_graphics();
+        gs_vertexbuffer_destroy(buffer->vertex_buffer);
+        buffer->vertex_buffer = create_vertex_buffer(capacity);
+        obs_leave_graphics();
+        renderer->graphics_lock_ns += os_gettime_ns() - lock_start;
+
+        buffer->capacity = buffer->vertex_buffer ? capacity : 0;
+        renderer->buffer_allocations++;
+        if (!buffer->vertex_buffer) {
+            blog(LOG_ERROR, "[RENDER] Failed to create vertex buffer");
+            return -1;
         }
     }
-    
-    
-    // Process alpha channel for each pixel
-    // GDI writes in BGRA format
-    for (int i = 0; i < width * height; i++) {
-        uint32_t pixel = pixels[i];
-        uint8_t b = pixel & 0xFF;
-        uint8_t g = (pixel >> 8) & 0xFF;
-        uint8_t r = (pixel >> 16) & 0xFF;
-        
-        if (context->show_background) {
-            // Background is visible
-            // Check if this pixel is different from the fill color (background)
-            bool is_text = (r != fill_r || g != fill_g || b != fill_b);
-            
-            if (is_text) {
-                // This is text - make it fully opaque
-                pixels[i] = (255 << 24) | (r << 16) | (g << 8) | b;
+
+    if (!buffer->vertex_buffer)
+        return -1;
+
+    // The CPU-side arrays belong to the buffer; no graphics lock until the flush
+    struct gs_vb_data* vb = gs_vertexbuffer_get_data(buffer->vertex_buffer);
+    struct vec2* uvs = (struct vec2*)vb->tvarray[0].array;
+    const float inv_width = 1.0f / (float)frame->atlas_width;
+    const float inv_height = 1.0f / (float)frame->atlas_height;
+
+    for (size_t i = 0; i < count; i++) {
+        const text_vertex& vertex = frame->vertices[i];
+        vec3_set(&vb->points[i], vertex.x, vertex.y, 0.0f);
+        vec2_set(&uvs[i], vertex.u * inv_width, vertex.v * inv_height);
+    }
+
+    buffer->count = (uint32_t)count;
+    return slot;
+}
+
+// Follow each entry from its previous row so a scroll glides instead of jumping
+static void update_rows(text_renderer* renderer, const text_frame* frame, uint64_t now)
+{
+    std::vector<text_row> rows;
+    rows.reserve(frame->lines.size());
+
+    for (const text_frame_line& line : frame->lines) {
+        text_row row = { line.entry_id, line.first, line.count, line.row, 0.0f, 0, 0.0f, 0.0f };
+
+        for (const text_row& previous : renderer->rows) {
+            if (previous.entry_id != line.entry_id)
+                continue;
+
+            row.opacity = previous.opacity;
+            if (previous.row == line.row) {
+                row.slide_from = previous.slide_from;
+                row.slide_start_ns = previous.slide_start_ns;
+                row.offset = previous.offset;
             } else {
-                // This is background - use background alpha
-                pixels[i] = (bg_alpha << 24) | (r << 16) | (g << 8) | b;
+                // Start from wherever it is drawn right now
+                row.slide_from = previous.offset + (float)((previous.row - line.row) * frame->line_height);
+                row.slide_start_ns = now;
+                row.offset = row.slide_from;
             }
-        } else {
-            // Background is transparent
-            // We filled with text color, so pixels that match fill are background (transparent)
-            // Pixels that differ are text (may be anti-aliased)
-            
-            bool is_background = (r == fill_r && g == fill_g && b == fill_b);
-            
-            if (is_background) {
-                // Pure background - make fully transparent
-                pixels[i] = (0 << 24) | (r << 16) | (g << 8) | b;
+            break;
+        }
+
+        rows.push_back(row);
+    }
+
+    renderer->rows.swap(rows);
+}
+
+// Per-tick opacity and slide offset of every drawn line
+static void animate_rows(text_renderer* renderer, uint64_t now)
+{
+    for (text_row& row : renderer->rows) {
+        // Entries removed since the frame was built stay hidden until the next one lands
+        row.opacity = 0.0f;
+        for (const auto& alpha : renderer->entry_alpha) {
+            if (alpha.first == row.entry_id) {
+                row.opacity = alpha.second;
+                break;
+            }
+        }
+
+        if (row.slide_from != 0.0f) {
+            uint64_t elapsed = now - row.slide_start_ns;
+            if (elapsed >= TEXT_SLIDE_NS) {
+                row.slide_from = 0.0f;
+                row.offset = 0.0f;
             } else {
-                // This pixel has been modified by text rendering
-                // It's either pure text or anti-aliased edge
-                // Make it fully opaque (anti-aliasing already in RGB values)
-                pixels[i] = (255 << 24) | (r << 16) | (g << 8) | b;
+                // Ease out
+                float t = 1.0f - (float)elapsed / (float)TEXT_SLIDE_NS;
+                row.offset = row.slide_from * t * t;
             }
         }
     }
-    
-    obs_enter_graphics();
-    
-    if (context->texture) {
-        gs_texture_destroy(context->texture);
-        context->texture = nullptr;
+}
+
+// Upload the newest finished frame, if the worker published one
+static void take_frame(keystroke_source* context, text_renderer* renderer, uint64_t now)
+{
+    int slot;
+    {
+        std::lock_guard<std::mutex> lock(renderer->frame_mutex);
+        slot = renderer->ready_frame;
+        if (slot < 0)
+            return;
+        renderer->ready_frame = -1;
+        renderer->reading_frame = slot;
     }
-    
-    context->texture = gs_texture_create(width, height, GS_BGRA, 1,
-        (const uint8_t**)&pixels, 0);
-    
-    if (!context->texture) {
-        blog(LOG_ERROR, "[RENDER] Failed to create texture");
+
+    const text_frame* frame = &renderer->frames[slot];
+    if (frame->has_content) {
+        int buffer = prepare_vertices(renderer, frame);
+
+        uint64_t lock_start = os_gettime_ns();
+        obs_enter_graphics();
+        upload_atlas(renderer, frame);
+        if (buffer >= 0) {
+            gs_vertexbuffer_flush(renderer->buffers[buffer].vertex_buffer);
+            renderer->current_buffer = buffer;
+        }
+        obs_leave_graphics();
+
+        uint64_t held = os_gettime_ns() - lock_start;
+        renderer->graphics_lock_ns += held;
+        if (held > renderer->graphics_lock_max_ns)
+            renderer->graphics_lock_max_ns = held;
+
+        if (buffer >= 0)
+            update_rows(renderer, frame, now);
+        context->cx = frame->cx;
+        context->cy = frame->cy;
     } else {
-        context->cx = width;
-        context->cy = height;
+        renderer->rows.clear();
     }
-    
-    obs_leave_graphics();
-    
-    // Cleanup GDI resources
-    SelectObject(hdc, hOldFont);
-    DeleteObject(hFont);
-    SelectObject(hdc, hOldBitmap);
-    DeleteObject(hBitmap);
-    DeleteDC(hdc);
-}
\ No newline at end of file
+    renderer->has_content = frame->has_content;
+
+    std::lock_guard<std::mutex> lock(renderer->frame_mutex);
+    renderer->reading_frame = -1;
+}
+
+void text_renderer_update(keystroke_source* context)
+{
+    if (!context || !context->renderer) {
+        blog(LOG_ERROR, "[RENDER] context is null");
+        return;
+    }
+
+    text_renderer* renderer = context->renderer;
+
+    // Snapshot entries and settings while holding the lock briefly - only if something
+    // changed. Both generations are atomic, so quiet ticks never touch entries_mutex.
+    std::unique_ptr<text_layout_request> request;
+    uint64_t generation = context->history_generation.load(std::memory_order_acquire);
+    uint64_t alpha_generation = context->alpha_generation.load(std::memory_order_acquire);
+    if (generation == renderer->built_generation && alpha_generation == renderer->alpha_generation) {
+        renderer->rebuilds_skipped++;
+    } else {
+        std::lock_guard<std::mutex> lock(context->entries_mutex);
+        renderer->alpha_generation = context->alpha_generation.load(std::memory_order_relaxed);
+        if (context->history_generation.load(std::memory_order_relaxed) == renderer->built_generation) {
+            renderer->rebuilds_skipped++;
+        } else {
+            renderer->built_generation = context->history_generation.load(std::memory_order_relaxed);
+
+            request.reset(new text_layout_request());
+            // Snapshot in row order, top row first
+            const keystroke_history* history = &context->history;
+            request->entries.reserve(history->count);
+            for (uint32_t row = 0; row < history->count; row++) {
+                request->entries.push_back(*keystroke_history_row(history, row, context->display_newest_on_top));
+            }
+            request->font = context->font;
+            request->font_size = context->font_size;
+            request->text_alignment = context->text_alignment;
+            request->display_newest_on_top = context->display_newest_on_top;
+            request->max_entries = context->max_entries;
+
+            // Colors are effect parameters: a color change never touches the geometry
+            // Settings hold 0xBBGGRR; the color picker has no alpha channel
+            renderer->text_color = context->font_color | 0xFF000000;
+            uint32_t bg_alpha = context->show_background ?
+                (uint32_t)(context->background_opacity * 255.0f) : 0;
+            renderer->background_color = (context->background_color & 0xFFFFFF) | (bg_alpha << 24);
+        }
+
+        // Opacity changes every tick during a fade; it never needs a new frame
+        renderer->entry_alpha.clear();
+        for (uint32_t i = 0; i < context->history.count; i++) {
+            const keystroke_entry* entry = keystroke_history_at(&context->history, i);
+            renderer->entry_alpha.emplace_back(entry->id, entry->alpha);
+        }
+    }
+
+    if (request) {
+        {
+            std::lock_guard<std::mutex> lock(renderer->frame_mutex);
+            if (renderer->pending)
+                renderer->requests_coalesced++;
+            renderer->pending = std::move(request);
+        }
+        renderer->wake.notify_one();
+    }
+
+    uint64_t now = os_gettime_ns();
+    take_frame(context, renderer, now);
+    animate_rows(renderer, now);
+}
+
+void text_renderer_draw(keystroke_source* context)
+{
+    text_renderer* renderer = context->renderer;
+    if (!renderer || !renderer->has_content)
+        return;
+
+    if (renderer->background_color >> 24) {
+        gs_effect_t* solid = obs_get_base_effect(OBS_EFFECT_SOLID);
+        gs_eparam_t* color = gs_effect_get_param_by_name(solid, "color");
+
+        struct vec4 background;
+        vec4_from_rgba(&background, renderer->background_color);
+        gs_effect_set_vec4(color, &background);
+
+        while (gs_effect_loop(solid, "Solid")) {
+            gs_draw_sprite(nullptr, 0, context->cx, context->cy);
+        }
+    }
+
+    if (!renderer->effect || !renderer->atlas_texture || renderer->current_buffer < 0)
+        return;
+
+    const text_vertex_buffer* buffer = &renderer->buffers[renderer->current_buffer];
+    if (buffer->count == 0)
+        return;
+
+    gs_eparam_t* image = gs_effect_get_param_by_name(renderer->effect, "image");
+    gs_effect_set_texture(image, renderer->atlas_texture);
+
+    struct vec4 text_color;
+    vec4_from_rgba(&text_color, renderer->text_color);
+    gs_effect_set_vec4(gs_effect_get_param_by_name(renderer->effect, "color"), &text_color);
+
+    gs_eparam_t* opacity = gs_effect_get_param_by_name(renderer->effect, "opacity");
+    gs_eparam_t* offset = gs_effect_get_param_by_name(renderer->effect, "offset");
+
+    gs_load_vertexbuffer(buffer->vertex_buffer);
+    gs_load_indexbuffer(nullptr);
+
+    // One draw per line; parameters set inside the pass are applied by gs_draw
+    while (gs_effect_loop(renderer->effect, "Draw")) {
+        for (const text_row& row : renderer->rows) {
+            if (row.opacity <= 0.0f || row.count == 0)
+                continue;
+            gs_effect_set_float(opacity, row.opacity);
+            gs_effect_set_float(offset, row.offset);
+            gs_draw(GS_TRIS, row.first, row.count);
+        }
+    }
+
+    gs_load_vertexbuffer(nullptr);
+}
@@ -1,6 +1,133 @@
 #pragma once
 
 #include "keystroke-source.h"
+#include "glyph-atlas.h"
+#include "line-cache.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <thread>
 
-// Render the keystroke history to a texture
-void render_text_to_texture(keystroke_source* context);
+// Vertex buffers in flight: each upload goes to the one the last draw didn't use
+#define TEXT_VERTEX_BUFFERS 2
+
+// Layout frames shared with the worker: one being built, one ready or uploading
+#define TEXT_FRAMES 2
+
+// Time a line takes to glide to its new row when the history scrolls
+#define TEXT_SLIDE_NS 150000000ULL
+
+struct text_vertex_buffer {
+    gs_vertbuffer_t* vertex_buffer;  // GS_DYNAMIC, recreated only to grow
+    size_t capacity;
+    uint32_t count;                  // Vertices of the current layout
+};
+
+// Everything the worker needs for one layout; immutable once submitted
+struct text_layout_request {
+    std::vector<keystroke_entry> entries;  // Top row first
+    std::shared_ptr<font_face> font;  // nullptr if the font failed to load
+    int font_size;
+    std::string text_alignment;
+    bool display_newest_on_top;
+    int max_entries;
+};
+
+// One history entry's run of vertices inside a frame
+struct text_frame_line {
+    uint64_t entry_id;
+    uint32_t first;                      // First vertex
+    uint32_t count;
+    int row;
+};
+
+// A finished layout, ready to upload
+struct text_frame {
+    std::vector<text_vertex> vertices;   // 6 per glyph, atlas texel coordinates
+    std::vector<text_frame_line> lines;
+    int line_height;
+    std::vector<uint8_t> atlas_pixels;   // Used rows only, when the atlas changed since the last upload
+    bool has_atlas;
+    uint32_t atlas_width;
+    uint32_t atlas_height;               // Texture size; rows past atlas_rows are never sampled
+    uint32_t atlas_rows;
+    uint64_t atlas_revision;
+    bool has_content;
+    uint32_t cx;
+    uint32_t cy;
+};
+
+// A line as drawn: its vertex range plus per-frame animation state. Opacity
+// and the slide offset are effect parameters, so animating them is one draw
+// call per line and never touches the geometry.
+struct text_row {
+    uint64_t entry_id;
+    uint32_t first;
+    uint32_t count;
+    int row;
+    float slide_from;                    // Offset in px when the slide started
+    uint64_t slide_start_ns;
+    float offset;                        // Current vertical offset in px
+    float opacity;
+};
+
+// Keystroke history drawn as textured quads over a shared glyph atlas.
+// A worker thread turns history snapshots into frames (layout and glyph
+// rasterization); the video tick only submits snapshots and uploads the
+// newest finished frame, and video_render draws it.
+struct text_renderer {
+    // Worker-owned layout state
+    glyph_atlas atlas;
+    std::string line_key;               // Scratch for line cache keys
+    line_cache lines;                   // Laid-out lines, valid for lines_epoch
+    uint32_t lines_epoch;               // Atlas epoch the cached lines refer to
+    uint64_t atlas_revision;            // Bumped whenever atlas pixels change
+
+    // Hand-off between the tick and the worker (frame_mutex)
+    std::thread worker;
+    std::mutex frame_mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::unique_ptr<text_layout_request> pending; // Newest unprocessed snapshot
+    text_frame frames[TEXT_FRAMES];
+    int ready_frame;                    // Finished and not yet taken, -1 = none
+    int reading_frame;                  // Being uploaded by the tick, -1 = none
+    std::atomic<uint64_t> uploaded_atlas_revision;
+
+    // Video thread state
+    bool has_content;
+    uint32_t text_color;                // 0xAABBGGRR, "color" effect parameter
+    uint32_t background_color;          // 0xAABBGGRR, alpha 0 = no background
+    uint64_t built_generation;          // history_generation of the last snapshot
+    uint64_t alpha_generation;          // alpha_generation behind entry_alpha
+    std::vector<text_row> rows;         // Lines of the uploaded frame
+    std::vector<std::pair<uint64_t, float>> entry_alpha; // Scratch: id -> alpha this tick
+
+    // Diagnostics
+    uint64_t rebuilds_performed;     // Frames built by the worker
+    uint64_t rebuilds_skipped;
+    uint64_t requests_coalesced;     // Snapshots replaced before the worker got to them
+    uint64_t frames_dropped;         // Finished frames replaced before upload
+    uint64_t texture_allocations;
+    uint64_t buffer_allocations;
+    uint64_t graphics_lock_ns;       // Total time inside obs_enter_graphics
+    uint64_t graphics_lock_max_ns;
+    uint64_t atlas_bytes_uploaded;
+
+    // Graphics objects
+    gs_effect_t* effect;
+    gs_texture_t* atlas_texture;     // GS_DYNAMIC, recreated only when the atlas grows
+    uint32_t texture_height;
+    text_vertex_buffer buffers[TEXT_VERTEX_BUFFERS];
+    int current_buffer;              // Last flushed buffer, -1 before the first upload
+};
+
+text_renderer* text_renderer_create();
+void text_renderer_destroy(text_renderer* renderer);
+
+// Hand the worker a snapshot if history_generation moved, upload the newest
+// finished frame, if any, and advance the line animations (video tick)
+void text_renderer_update(keystroke_source* context);
+
+// Draw the uploaded geometry (video render)
+void text_renderer_draw(keystroke_source* context);
@@ -0,0 +1,225 @@
+#include "window-matcher.h"
+#include <cctype>
+#include <cstring>
+#include <deque>
+#include <map>
+
+static const uint32_t no_state = UINT32_MAX;
+
+static std::string trim(const std::string& value)
+{
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos)
+        return "";
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+static uint8_t fold(uint8_t c)
+{
+    return (uint8_t)tolower(c);
+}
+
+void window_matcher_compile(window_matcher* matcher, const std::string& spec,
+    window_matcher_syntax syntax)
+{
+    matcher->patterns.clear();
+    matcher->has_includes = false;
+    matcher->transitions.clear();
+    matcher->output_begin.clear();
+    matcher->outputs.clear();
+    memset(matcher->char_class, 0, sizeof(matcher->char_class));
+    matcher->class_count = 1;
+
+    // Split the spec into patterns, then each pattern into literal fragments
+    std::map<std::string, uint32_t> fragment_ids;
+    std::vector<std::string> fragments;
+    std::vector<std::vector<window_fragment_use>> fragment_uses;
+
+    bool literal = syntax == WINDOW_MATCHER_LITERALS;
+    const char* separators = literal ? "\r\n" : ";\r\n";
+
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t end = spec.find_first_of(separators, pos);
+        if (end == std::string::npos)
+            end = spec.size();
+        std::string token = trim(spec.substr(pos, end - pos));
+        pos = end + 1;
+
+        window_pattern pattern = {};
+        if (!literal && !token.empty() && token[0] == '!') {
+            pattern.exclude = true;
+            token = trim(token.substr(1));
+        }
+        if (token.empty())
+            continue;
+
+        for (auto& c : token) {
+            c = (char)fold((uint8_t)c);
+        }
+
+        // Plain text is a substring match; globs are anchored unless they start/end with '*'
+        bool is_glob = !literal && token.find('*') != std::string::npos;
+        pattern.anchored_start = is_glob && token.front() != '*';
+        pattern.anchored_end = is_glob && token.back() != '*';
+
+        uint32_t pattern_index = (uint32_t)matcher->patterns.size();
+        size_t frag_pos = 0;
+        while (frag_pos <= token.size()) {
+            size_t frag_end = literal ? std::string::npos : token.find('*', frag_pos);
+            if (frag_end == std::string::npos)
+                frag_end = token.size();
+            std::string fragment = token.substr(frag_pos, frag_end - frag_pos);
+            frag_pos = frag_end + 1;
+            if (fragment.empty())
+                continue;
+
+            auto it = fragment_ids.find(fragment);
+            uint32_t id;
+            if (it == fragment_ids.end()) {
+                id = (uint32_t)fragments.size();
+                fragment_ids[fragment] = id;
+                fragments.push_back(fragment);
+                fragment_uses.emplace_back();
+            } else {
+                id = it->second;
+            }
+
+            fragment_uses[id].push_back({ pattern_index, pattern.fragment_count,
+                (uint32_t)fragment.size() });
+            pattern.fragment_count++;
+        }
+
+        matcher->has_includes = matcher->has_includes || !pattern.exclude;
+        matcher->patterns.push_back(pattern);
+    }
+
+    // Compress the alphabet to the characters that actually occur in fragments
+    uint8_t folded_class[256] = {0};
+    for (const auto& fragment : fragments) {
+        for (char c : fragment) {
+            uint8_t folded = (uint8_t)c;
+            if (folded_class[folded] == 0) {
+                folded_class[folded] = (uint8_t)matcher->class_count++;
+            }
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        matcher->char_class[c] = folded_class[fold((uint8_t)c)];
+    }
+
+    // Build the trie
+    const uint32_t classes = matcher->class_count;
+    std::vector<uint32_t>& next = matcher->transitions;
+    std::vector<std::vector<window_fragment_use>> state_outputs(1);
+    next.assign(classes, no_state);
+
+    for (size_t id = 0; id < fragments.size(); id++) {
+        uint32_t state = 0;
+        for (char c : fragments[id]) {
+            uint32_t cls = folded_class[(uint8_t)c];
+            if (next[state * classes + cls] == no_state) {
+                next[state * classes + cls] = (uint32_t)state_outputs.size();
+                state_outputs.emplace_back();
+                next.resize(next.size() + classes, no_state);
+            }
+            state = next[state * classes + cls];
+        }
+        state_outputs[state].insert(state_outputs[state].end(),
+            fragment_uses[id].begin(), fragment_uses[id].end());
+    }
+
+    // Breadth-first pass: failure links, turned into a full transition table
+    std::vector<uint32_t> fail(state_outputs.size(), 0);
+    std::deque<uint32_t> queue;
+
+    for (uint32_t cls = 0; cls < classes; cls++) {
+        uint32_t child = next[cls];
+        if (child == no_state) {
+            next[cls] = 0;
+        } else {
+            fail[child] = 0;
+            queue.push_back(child);
+        }
+    }
+
+    while (!queue.empty()) {
+        uint32_t state = queue.front();
+        queue.pop_front();
+
+        // Inherit the matches of the longest proper suffix
+        const auto& inherited = state_outputs[fail[state]];
+        state_outputs[state].insert(state_outputs[state].end(), inherited.begin(), inherited.end());
+
+        for (uint32_t cls = 0; cls < classes; cls++) {
+            uint32_t child = next[state * classes + cls];
+            if (child == no_state) {
+                next[state * classes + cls] = next[fail[state] * classes + cls];
+            } else {
+                fail[child] = next[fail[state] * classes + cls];
+                queue.push_back(child);
+            }
+        }
+    }
+
+    // Flatten per-state outputs
+    matcher->output_begin.reserve(state_outputs.size() + 1);
+    for (const auto& outputs : state_outputs) {
+        matcher->output_begin.push_back((uint32_t)matcher->outputs.size());
+        matcher->outputs.insert(matcher->outputs.end(), outputs.begin(), outputs.end());
+    }
+    matcher->output_begin.push_back((uint32_t)matcher->outputs.size());
+}
+
+bool window_matcher_empty(const window_matcher* matcher)
+{
+    return matcher->patterns.empty();
+}
+
+bool window_matcher_match(const window_matcher* matcher, const char* title)
+{
+    if (matcher->patterns.empty())
+        return true;
+
+    // Per pattern: how many fragments matched so far, and where the next may start.
+    // Taking the earliest-ending occurrence of each fragment in order is optimal.
+    size_t count = matcher->patterns.size();
+    std::vector<uint32_t> progress(count, 0);
+    std::vector<size_t> min_start(count, 0);
+
+    const size_t length = strlen(title);
+    const uint32_t classes = matcher->class_count;
+    uint32_t state = 0;
+
+    for (size_t i = 0; i < length; i++) {
+        state = matcher->transitions[state * classes + matcher->char_class[(uint8_t)title[i]]];
+
+        for (uint32_t o = matcher->output_begin[state]; o < matcher->output_begin[state + 1]; o++) {
+            const window_fragment_use& use = matcher->outputs[o];
+            const window_pattern& pattern = matcher->patterns[use.pattern];
+            size_t start = i + 1 - use.length;
+
+            if (progress[use.pattern] != use.position || start < min_start[use.pattern])
+                continue;
+            if (use.position == 0 && pattern.anchored_start && start != 0)
+                continue;
+            if (use.position + 1 == pattern.fragment_count && pattern.anchored_end && i + 1 != length)
+                continue;
+
+            progress[use.pattern]++;
+            min_start[use.pattern] = i + 1;
+        }
+    }
+
+    bool included = !matcher->has_includes;
+    for (size_t p = 0; p < count; p++) {
+        if (progress[p] != matcher->patterns[p].fragment_count)
+            continue;
+        if (matcher->patterns[p].exclude)
+            return false;
+        included = true;
+    }
+
+    return included;
+}
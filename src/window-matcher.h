@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One compiled rule from the target window setting
+struct window_pattern {
+    bool exclude;          // "!pattern" - never capture when it matches
+    bool anchored_start;   // glob without a leading '*'
+    bool anchored_end;     // glob without a trailing '*'
+    uint32_t fragment_count;
+};
+
+// Where a literal fragment is used: pattern index + position within the pattern
+struct window_fragment_use {
+    uint32_t pattern;
+    uint32_t position;
+    uint32_t length;   // Fragment length, to recover the match start
+};
+
+// Case-insensitive multi-pattern window title matcher.
+//
+// Every pattern is split on '*' into literal fragments. All fragments go into
+// one Aho-Corasick automaton over a compressed, case-folded alphabet, so a
+// title is matched in a single pass regardless of how many patterns exist.
+// Plain patterns (no '*') keep the old "title contains text" behavior.
+struct window_matcher {
+    std::vector<window_pattern> patterns;
+    bool has_includes;
+
+    // Automaton
+    uint8_t char_class[256];                  // folded byte -> alphabet class (0 = not in any pattern)
+    uint32_t class_count;
+    std::vector<uint32_t> transitions;        // state * class_count + class -> next state
+    std::vector<uint32_t> output_begin;       // per state, range into outputs (size states + 1)
+    std::vector<window_fragment_use> outputs; // fragment uses completed at each state
+};
+
+// How a spec is read
+enum window_matcher_syntax {
+    WINDOW_MATCHER_PATTERNS,    // Separated by newlines or ';', '!' excludes, '*' is a wildcard
+    WINDOW_MATCHER_LITERALS,    // One plain text per line, every character taken as typed
+};
+
+// Compile a pattern list. Empty list = match all.
+void window_matcher_compile(window_matcher* matcher, const std::string& spec,
+    window_matcher_syntax syntax = WINDOW_MATCHER_PATTERNS);
+
+// True if the title matches any include pattern (or there are none) and no exclude pattern
+bool window_matcher_match(const window_matcher* matcher, const char* title);
+
+// True if nothing was compiled (every window matches)
+bool window_matcher_empty(const window_matcher* matcher);
+
+// Streaming use (one byte at a time, e.g. over typed characters). Only the
+// literal fragments matter here: a match is reported whenever any fragment
+// ends at the current position. State 0 is the start state.
+static inline uint32_t window_matcher_step(const window_matcher* matcher, uint32_t state, uint8_t c)
+{
+    return matcher->transitions[state * matcher->class_count + matcher->char_class[c]];
+}
+
+static inline bool window_matcher_state_matches(const window_matcher* matcher, uint32_t state)
+{
+    return matcher->output_begin[state] != matcher->output_begin[state + 1];
+}
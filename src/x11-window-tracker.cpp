@@ -0,0 +1,307 @@
+#include "x11-window-tracker.h"
+#include <obs-module.h>
+#include <util/platform.h>
+#include <xcb/xcb.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+// Longest property value read, in 32-bit units (titles are capped well below this)
+#define X11_PROPERTY_WORDS 1024
+
+enum tracker_atom {
+    ATOM_NET_ACTIVE_WINDOW,
+    ATOM_NET_WM_NAME,
+    ATOM_NET_WM_PID,
+    ATOM_UTF8_STRING,
+    ATOM_COUNT,
+};
+
+static const char* const atom_names[ATOM_COUNT] = {
+    "_NET_ACTIVE_WINDOW",
+    "_NET_WM_NAME",
+    "_NET_WM_PID",
+    "UTF8_STRING",
+};
+
+struct x11_window_tracker {
+    xcb_connection_t* connection;
+    xcb_window_t root;
+    xcb_atom_t atoms[ATOM_COUNT];
+    int stop_fd;                // eventfd, signalled by destroy
+    std::thread thread;
+
+    // Owned by the thread (by create before it starts)
+    xcb_window_t watched;       // Window whose property changes we receive
+    uint64_t changes;
+
+    std::atomic<uint32_t> serial;
+    std::shared_ptr<const x11_window_snapshot> snapshot; // std::atomic_load/store only
+};
+
+// Raw property bytes; empty if the property is unset or the window is gone
+static std::string get_property(x11_window_tracker* tracker, xcb_window_t window,
+    xcb_atom_t property, xcb_atom_t type)
+{
+    xcb_get_property_cookie_t cookie = xcb_get_property(tracker->connection, 0, window,
+        property, type, 0, X11_PROPERTY_WORDS);
+    xcb_get_property_reply_t* reply = xcb_get_property_reply(tracker->connection, cookie, nullptr);
+    if (!reply)
+        return std::string();
+
+    std::string value((const char*)xcb_get_property_value(reply),
+        (size_t)xcb_get_property_value_length(reply));
+    free(reply);
+    return value;
+}
+
+static uint32_t get_cardinal(x11_window_tracker* tracker, xcb_window_t window,
+    xcb_atom_t property, xcb_atom_t type)
+{
+    std::string value = get_property(tracker, window, property, type);
+    uint32_t result = 0;
+    if (value.size() >= sizeof(result))
+        memcpy(&result, value.data(), sizeof(result));
+    return result;
+}
+
+static std::string read_title(x11_window_tracker* tracker, xcb_window_t window)
+{
+    std::string title = get_property(tracker, window,
+        tracker->atoms[ATOM_NET_WM_NAME], tracker->atoms[ATOM_UTF8_STRING]);
+    if (title.empty())
+        title = get_property(tracker, window, XCB_ATOM_WM_NAME, XCB_ATOM_STRING);
+
+    // Some clients include the terminator
+    size_t end = title.find('\0');
+    if (end != std::string::npos)
+        title.resize(end);
+    return title;
+}
+
+static void publish(x11_window_tracker* tracker, std::shared_ptr<const x11_window_snapshot> snapshot)
+{
+    std::atomic_store(&tracker->snapshot, std::move(snapshot));
+    tracker->serial.fetch_add(1, std::memory_order_release);
+    tracker->changes++;
+}
+
+// Only our own client's event mask changes; other clients' selections are unaffected
+static void watch_window(x11_window_tracker* tracker, xcb_window_t window)
+{
+    if (window == tracker->watched)
+        return;
+
+    const uint32_t none = XCB_EVENT_MASK_NO_EVENT;
+    const uint32_t property_change = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    if (tracker->watched)
+        xcb_change_window_attributes(tracker->connection, tracker->watched, XCB_CW_EVENT_MASK, &none);
+    if (window)
+        xcb_change_window_attributes(tracker->connection, window, XCB_CW_EVENT_MASK, &property_change);
+    tracker->watched = window;
+}
+
+// Re-read everything about the active window (focus moved)
+static void refresh_active_window(x11_window_tracker* tracker)
+{
+    auto snapshot = std::make_shared<x11_window_snapshot>();
+    snapshot->window = get_cardinal(tracker, tracker->root,
+        tracker->atoms[ATOM_NET_ACTIVE_WINDOW], XCB_ATOM_WINDOW);
+    snapshot->pid = 0;
+
+    watch_window(tracker, snapshot->window);
+
+    if (snapshot->window) {
+        snapshot->title = read_title(tracker, snapshot->window);
+        snapshot->pid = get_cardinal(tracker, snapshot->window,
+            tracker->atoms[ATOM_NET_WM_PID], XCB_ATOM_CARDINAL);
+
+        // WM_CLASS is "instance\0class\0"
+        std::string wm_class = get_property(tracker, snapshot->window, XCB_ATOM_WM_CLASS, XCB_ATOM_STRING);
+        size_t split = wm_class.find('\0');
+        if (split != std::string::npos)
+            snapshot->window_class = wm_class.c_str() + split + 1;
+    }
+
+    publish(tracker, std::move(snapshot));
+}
+
+// Same window, new title
+static void refresh_title(x11_window_tracker* tracker)
+{
+    auto current = std::atomic_load(&tracker->snapshot);
+    std::string title = read_title(tracker, current->window);
+    if (title == current->title)
+        return;
+
+    auto snapshot = std::make_shared<x11_window_snapshot>(*current);
+    snapshot->title = std::move(title);
+    publish(tracker, std::move(snapshot));
+}
+
+static void handle_event(x11_window_tracker* tracker, xcb_generic_event_t* event)
+{
+    // Errors (response_type 0) are expected when the active window is destroyed
+    if ((event->response_type & ~0x80) != XCB_PROPERTY_NOTIFY)
+        return;
+
+    xcb_property_notify_event_t* notify = (xcb_property_notify_event_t*)event;
+    if (notify->window == tracker->root) {
+        if (notify->atom == tracker->atoms[ATOM_NET_ACTIVE_WINDOW])
+            refresh_active_window(tracker);
+    } else if (notify->window == tracker->watched) {
+        if (notify->atom == tracker->atoms[ATOM_NET_WM_NAME] || notify->atom == XCB_ATOM_WM_NAME)
+            refresh_title(tracker);
+    }
+}
+
+static void tracker_thread(x11_window_tracker* tracker)
+{
+    os_set_thread_name("keystroke-history: x11");
+
+    struct pollfd fds[2];
+    fds[0].fd = xcb_get_file_descriptor(tracker->connection);
+    fds[0].events = POLLIN;
+    fds[1].fd = tracker->stop_fd;
+    fds[1].events = POLLIN;
+
+    for (;;) {
+        // Handling an event makes requests, which may queue further events
+        // without the socket becoming readable again - drain before sleeping
+        while (xcb_generic_event_t* event = xcb_poll_for_event(tracker->connection)) {
+            handle_event(tracker, event);
+            free(event);
+        }
+        xcb_flush(tracker->connection);
+
+        if (xcb_connection_has_error(tracker->connection)) {
+            blog(LOG_WARNING, "[FILTER] Lost the X server connection, active window no longer tracked");
+            return;
+        }
+
+        if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+            blog(LOG_ERROR, "[FILTER] poll failed: %s", strerror(errno));
+            return;
+        }
+        if (fds[1].revents)
+            return;
+    }
+}
+
+x11_window_tracker* x11_window_tracker_create(const char* display_name)
+{
+    xcb_connection_t* connection = xcb_connect(display_name, nullptr);
+    if (xcb_connection_has_error(connection)) {
+        xcb_disconnect(connection);
+        return nullptr;
+    }
+
+    xcb_intern_atom_cookie_t cookies[ATOM_COUNT];
+    for (int i = 0; i < ATOM_COUNT; i++) {
+        cookies[i] = xcb_intern_atom(connection, 0, (uint16_t)strlen(atom_names[i]), atom_names[i]);
+    }
+
+    xcb_atom_t atoms[ATOM_COUNT];
+    for (int i = 0; i < ATOM_COUNT; i++) {
+        xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(connection, cookies[i], nullptr);
+        atoms[i] = reply ? reply->atom : (xcb_atom_t)XCB_ATOM_NONE;
+        free(reply);
+    }
+
+    // Only EWMH window managers say which window is active
+    xcb_window_t root = xcb_setup_roots_iterator(xcb_get_setup(connection)).data->root;
+    xcb_get_property_reply_t* supported = xcb_get_property_reply(connection,
+        xcb_get_property(connection, 0, root, atoms[ATOM_NET_ACTIVE_WINDOW], XCB_ATOM_WINDOW, 0, 1), nullptr);
+    bool has_active = supported && supported->type == XCB_ATOM_WINDOW;
+    free(supported);
+    if (!has_active) {
+        blog(LOG_WARNING, "[FILTER] Window manager doesn't set _NET_ACTIVE_WINDOW, window filter disabled");
+        xcb_disconnect(connection);
+        return nullptr;
+    }
+
+    int stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (stop_fd < 0) {
+        blog(LOG_ERROR, "[FILTER] Failed to create eventfd: %s", strerror(errno));
+        xcb_disconnect(connection);
+        return nullptr;
+    }
+
+    x11_window_tracker* tracker = new x11_window_tracker();
+    tracker->connection = connection;
+    tracker->root = root;
+    memcpy(tracker->atoms, atoms, sizeof(atoms));
+    tracker->stop_fd = stop_fd;
+    tracker->watched = XCB_WINDOW_NONE;
+    tracker->changes = 0;
+    tracker->serial = 0;
+
+    const uint32_t property_change = XCB_EVENT_MASK_PROPERTY_CHANGE;
+    xcb_change_window_attributes(connection, root, XCB_CW_EVENT_MASK, &property_change);
+
+    // Readers see a valid snapshot before the thread's first event
+    refresh_active_window(tracker);
+    xcb_flush(connection);
+
+    tracker->thread = std::thread(tracker_thread, tracker);
+    return tracker;
+}
+
+void x11_window_tracker_destroy(x11_window_tracker* tracker)
+{
+    if (!tracker)
+        return;
+
+    uint64_t one = 1;
+    if (write(tracker->stop_fd, &one, sizeof(one)) < 0) {
+        blog(LOG_WARNING, "[FILTER] Failed to signal the X11 thread: %s", strerror(errno));
+    }
+    tracker->thread.join();
+
+    blog(LOG_INFO, "[FILTER] X11 active window: %llu changes",
+         (unsigned long long)tracker->changes);
+
+    close(tracker->stop_fd);
+    xcb_disconnect(tracker->connection);
+    delete tracker;
+}
+
+std::shared_ptr<const x11_window_snapshot> x11_window_tracker_get(x11_window_tracker* tracker)
+{
+    return std::atomic_load(&tracker->snapshot);
+}
+
+uint32_t x11_window_tracker_serial(x11_window_tracker* tracker)
+{
+    return tracker->serial.load(std::memory_order_acquire);
+}
+
+static bool x11_get_foreground(void* data, foreground_window_info* info)
+{
+    x11_window_tracker* tracker = static_cast<x11_window_tracker*>(data);
+    auto snapshot = std::atomic_load(&tracker->snapshot);
+    if (!snapshot->window)
+        return false;
+
+    info->id = (uintptr_t)snapshot->window;
+    size_t length = std::min(snapshot->title.size(), sizeof(info->title) - 1);
+    memcpy(info->title, snapshot->title.data(), length);
+    info->title[length] = '\0';
+    return true;
+}
+
+static uint32_t x11_get_serial(void* data)
+{
+    return x11_window_tracker_serial(static_cast<x11_window_tracker*>(data));
+}
+
+window_info_provider x11_window_tracker_provider(x11_window_tracker* tracker)
+{
+    return { x11_get_foreground, x11_get_serial, tracker };
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "filter-cache.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// The X11 active window as last reported by the window manager. Immutable once published.
+struct x11_window_snapshot {
+    uint32_t window;           // XID of _NET_ACTIVE_WINDOW (0 = none)
+    std::string title;         // _NET_WM_NAME, or WM_NAME if unset
+    std::string window_class;  // Class part of WM_CLASS
+    uint32_t pid;              // _NET_WM_PID (0 = not set)
+};
+
+// Follows the active window on its own xcb connection. A background thread
+// waits for PropertyNotify on the root window (_NET_ACTIVE_WINDOW) and on the
+// active window (_NET_WM_NAME / WM_NAME) and republishes the snapshot, so
+// readers never make a round trip to the X server. Linux only.
+struct x11_window_tracker;
+
+// Connects to display_name (nullptr = $DISPLAY). nullptr if there's no X server
+// or the window manager doesn't publish _NET_ACTIVE_WINDOW.
+x11_window_tracker* x11_window_tracker_create(const char* display_name);
+
+// Stops the thread and closes the connection
+void x11_window_tracker_destroy(x11_window_tracker* tracker);
+
+// Current snapshot (never nullptr for a live tracker). Safe from any thread.
+std::shared_ptr<const x11_window_snapshot> x11_window_tracker_get(x11_window_tracker* tracker);
+
+// Bumped after every published change; lets callers skip unchanged state
+uint32_t x11_window_tracker_serial(x11_window_tracker* tracker);
+
+// Foreground window provider for the window filter, reading the snapshot
+window_info_provider x11_window_tracker_provider(x11_window_tracker* tracker);